@@ -0,0 +1,254 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+// Compares the per-node placement path of SimpleBroadcast1Hop (std::map of
+// NodeData passed by value, sqrt+acos per candidate) with CandidateEvaluator.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "CandidateEvaluator.h"
+
+using namespace inet;
+
+namespace {
+
+// same layout as NodeData (simtime_t and L3Address replaced by same-size fields)
+struct PerNodeData
+{
+    int64_t timestamp;
+    int sequenceNumber;
+    uint64_t address[2];
+    double coord_x;
+    double coord_y;
+    double memoryActUsage;
+    double memoryMaxUsage;
+    double compActUsage;
+    double compMaxUsage;
+    bool hasCamera;
+    bool lockedCamera;
+    bool hasGPU;
+    bool lockedGPU;
+    bool lockedFly;
+    double radius;
+    uint32_t lastSeqNumber[16];
+    uint64_t nextHop_address[2];
+    int num_hops;
+};
+
+// copies of SimpleBroadcast1Hop::isDeployFeasible() / calculateProgressiveScore()
+bool isDeployFeasible(const TaskRequirements& task, PerNodeData node)
+{
+    bool ris = true;
+    if (task.reqPosition) {
+        double dx = node.coord_x - task.posX;
+        double dy = node.coord_y - task.posY;
+        if (dx * dx + dy * dy > task.range * task.range)
+            ris = false;
+    }
+    if ((task.reqGPU && node.lockedGPU) || (task.reqGPU && !node.hasGPU))
+        ris = false;
+    if (task.reqLockFly && node.lockedFly)
+        return false;
+    if ((task.reqCamera && node.lockedCamera) || (task.reqCamera && !node.hasCamera))
+        ris = false;
+    if ((task.reqCPU + node.compActUsage) > node.compMaxUsage)
+        ris = false;
+    if ((task.reqMemory + node.memoryActUsage) > node.memoryMaxUsage)
+        ris = false;
+    return ris;
+}
+
+double directionFactor(double xa, double ya, double xb, double yb, double xd, double yd, double alphaDegrees)
+{
+    double ADx = xd - xa;
+    double ADy = yd - ya;
+    double ABx = xb - xa;
+    double ABy = yb - ya;
+    double dot = (ADx * ABx) + (ADy * ABy);
+    double magAD = std::sqrt(ADx*ADx + ADy*ADy);
+    double magAB = std::sqrt(ABx*ABx + ABy*ABy);
+    if (magAD < 1e-9 || magAB < 1e-9)
+        return false;
+    double cosTheta = dot / (magAD * magAB);
+    if (cosTheta > 1.0)  cosTheta = 1.0;
+    else if (cosTheta < -1.0) cosTheta = -1.0;
+    double thetaDeg = std::acos(cosTheta) * 180.0 / M_PI;
+    if (thetaDeg <= 0.0)
+        return 1.0;
+    else if (thetaDeg >= alphaDegrees)
+        return 0.0;
+    else
+        return 1.0 - (thetaDeg / alphaDegrees);
+}
+
+double calculateProgressiveScore(const TaskRequirements& task, double ox, double oy, PerNodeData node)
+{
+    double pos_fact = 1, gpu_fact = 1, mem_fact = 1, cpu_fact = 1, fly_fact = 1, cam_fact = 1;
+    if (task.reqPosition)
+        pos_fact = directionFactor(ox, oy, node.coord_x, node.coord_y, task.posX, task.posY, 90);
+    if (task.reqGPU && (node.lockedGPU || !node.hasGPU))
+        gpu_fact = 0;
+    if (task.reqLockFly && node.lockedFly)
+        fly_fact = 0;
+    if ((task.reqCamera && node.lockedCamera) || (task.reqCamera && !node.hasCamera))
+        cam_fact = 0;
+    if ((task.reqCPU + node.compActUsage) > node.compMaxUsage)
+        cpu_fact = node.compMaxUsage / (task.reqCPU + node.compActUsage);
+    if ((task.reqMemory + node.memoryActUsage) > node.memoryMaxUsage)
+        mem_fact = node.memoryMaxUsage / (task.reqMemory + node.memoryActUsage);
+    return (0.5 * pos_fact) + (0.5 * ((gpu_fact + fly_fact + cam_fact + cpu_fact + mem_fact) / 5.0));
+}
+
+struct Columns
+{
+    std::vector<double> x, y, cpuAct, cpuMax, memAct, memMax;
+    std::vector<uint8_t> cam, lkCam, gpu, lkGpu, lkFly;
+
+    CandidateColumns view() const {
+        CandidateColumns c;
+        c.count = x.size();
+        c.coordX = x.data(); c.coordY = y.data();
+        c.compActUsage = cpuAct.data(); c.compMaxUsage = cpuMax.data();
+        c.memoryActUsage = memAct.data(); c.memoryMaxUsage = memMax.data();
+        c.hasCamera = cam.data(); c.lockedCamera = lkCam.data();
+        c.hasGPU = gpu.data(); c.lockedGPU = lkGpu.data(); c.lockedFly = lkFly.data();
+        return c;
+    }
+};
+
+double nowNs()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void runSize(int n, std::mt19937_64& rng)
+{
+    std::uniform_real_distribution<double> pos(0, 2500);
+    std::uniform_real_distribution<double> load(0, 100);
+    std::bernoulli_distribution coin(0.8);
+
+    std::map<uint32_t, PerNodeData> table;
+    Columns cols;
+    for (int i = 0; i < n; ++i) {
+        PerNodeData d = PerNodeData();
+        d.coord_x = pos(rng);
+        d.coord_y = pos(rng);
+        d.compMaxUsage = 100;
+        d.memoryMaxUsage = 100;
+        d.compActUsage = load(rng);
+        d.memoryActUsage = load(rng);
+        d.hasCamera = coin(rng);
+        d.lockedCamera = !coin(rng);
+        d.hasGPU = coin(rng);
+        d.lockedGPU = !coin(rng);
+        d.lockedFly = !coin(rng);
+        table[(uint32_t)i * 2654435761u] = d;
+    }
+    // columns in the same (address) order as the map
+    for (auto& kv : table) {
+        const PerNodeData& d = kv.second;
+        cols.x.push_back(d.coord_x); cols.y.push_back(d.coord_y);
+        cols.cpuAct.push_back(d.compActUsage); cols.cpuMax.push_back(d.compMaxUsage);
+        cols.memAct.push_back(d.memoryActUsage); cols.memMax.push_back(d.memoryMaxUsage);
+        cols.cam.push_back(d.hasCamera); cols.lkCam.push_back(d.lockedCamera);
+        cols.gpu.push_back(d.hasGPU); cols.lkGpu.push_back(d.lockedGPU); cols.lkFly.push_back(d.lockedFly);
+    }
+
+    // same shape as parseTask()
+    TaskRequirements req;
+    req.reqPosition = true;
+    req.posX = 1200;
+    req.posY = 1300;
+    req.range = 630;
+    req.reqCamera = true;
+    req.reqGPU = true;
+    req.reqCPU = 3;
+    req.reqMemory = 2;
+    double ox = 1000, oy = 900;
+
+    const int iters = std::max(20, 2000000 / n);
+    CandidateColumns view = cols.view();
+
+    std::vector<uint64_t> mask;
+    std::vector<double> scores;
+    std::vector<uint8_t> refFeasible(n);
+    std::vector<double> refScores(n);
+
+    // feasibility
+    long sink = 0;
+    double t0 = nowNs();
+    for (int it = 0; it < iters; ++it) {
+        int i = 0;
+        for (auto& kv : table)
+            refFeasible[i++] = isDeployFeasible(req, kv.second);
+        sink += refFeasible[it % n];
+    }
+    double tRefFeas = (nowNs() - t0) / ((double)iters * n);
+
+    t0 = nowNs();
+    for (int it = 0; it < iters; ++it) {
+        CandidateEvaluator::evaluateFeasibility(req, view, mask);
+        sink += mask[0] & 1;
+    }
+    double tBatchFeas = (nowNs() - t0) / ((double)iters * n);
+
+    // scores
+    t0 = nowNs();
+    for (int it = 0; it < iters; ++it) {
+        int i = 0;
+        for (auto& kv : table)
+            refScores[i++] = calculateProgressiveScore(req, ox, oy, kv.second);
+        sink += refScores[it % n] > 0.5;
+    }
+    double tRefScore = (nowNs() - t0) / ((double)iters * n);
+
+    t0 = nowNs();
+    for (int it = 0; it < iters; ++it) {
+        CandidateEvaluator::evaluateProgressiveScores(req, view, ox, oy, 90, scores);
+        sink += scores[0] > 0.5;
+    }
+    double tBatchScore = (nowNs() - t0) / ((double)iters * n);
+
+    // results must match the per-node path
+    int mismatches = 0;
+    for (int i = 0; i < n; ++i) {
+        if ((bool)refFeasible[i] != CandidateEvaluator::isFeasible(mask, i))
+            mismatches++;
+        if (std::fabs(refScores[i] - scores[i]) > 1e-9)
+            mismatches++;
+    }
+
+    printf("%6d candidates | feasibility: per-node %6.2f ns, batch %6.2f ns, speedup %5.1fx"
+           " | score: per-node %6.2f ns, batch %6.2f ns, speedup %5.1fx | mismatches %d (%ld)\n",
+            n, tRefFeas, tBatchFeas, tRefFeas / tBatchFeas, tRefScore, tBatchScore, tRefScore / tBatchScore,
+            mismatches, sink & 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::mt19937_64 rng(42);
+    printf("ns per candidate\n");
+    runSize(1000, rng);
+    runSize(10000, rng);
+    return 0;
+}
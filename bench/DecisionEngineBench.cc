@@ -0,0 +1,447 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+// Cost of the placement and table-merge paths of DecisionEngine on synthetic
+// tables of 100 to 100k nodes:
+//   - ns per candidate of the per-node checks and of CandidateEvaluator,
+//   - decisions per second (batch feasibility, candidate list, selection),
+//   - merged heartbeat entries per second.
+//
+// Usage: DecisionEngineBench [-w file] [-b file] [-t tolerance]
+//   -w  writes the measured costs to file
+//   -b  compares the costs with those written by another build and fails
+//       when any of them is more than tolerance (default 0.25) above it
+//
+// Every metric is stored as ns per item (lower is better) and is the best of
+// a few runs. Costs only compare on the same machine and load, so "make -C
+// bench check" builds the base revision and measures both in one run.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CandidateEvaluator.h"
+#include "DecisionEngine.h"
+
+using namespace inet;
+
+namespace {
+
+const int RUNS = 3;
+
+double nowNs()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- synthetic candidates ----
+
+struct Candidates
+{
+    std::vector<CandidateNode> nodes;
+    std::vector<double> x, y, cpuAct, cpuMax, memAct, memMax;
+    std::vector<uint8_t> cam, lkCam, gpu, lkGpu, lkFly;
+
+    CandidateColumns view() const {
+        CandidateColumns c;
+        c.count = x.size();
+        c.coordX = x.data(); c.coordY = y.data();
+        c.compActUsage = cpuAct.data(); c.compMaxUsage = cpuMax.data();
+        c.memoryActUsage = memAct.data(); c.memoryMaxUsage = memMax.data();
+        c.hasCamera = cam.data(); c.lockedCamera = lkCam.data();
+        c.hasGPU = gpu.data(); c.lockedGPU = lkGpu.data(); c.lockedFly = lkFly.data();
+        return c;
+    }
+};
+
+void makeCandidates(int n, std::mt19937_64& rng, Candidates& c)
+{
+    std::uniform_real_distribution<double> pos(0, 2500);
+    std::uniform_real_distribution<double> load(0, 100);
+    std::bernoulli_distribution coin(0.8);
+
+    for (int i = 0; i < n; ++i) {
+        CandidateNode d;
+        d.coordX = pos(rng);
+        d.coordY = pos(rng);
+        d.compMaxUsage = 100;
+        d.memoryMaxUsage = 100;
+        d.compActUsage = load(rng);
+        d.memoryActUsage = load(rng);
+        d.hasCamera = coin(rng);
+        d.lockedCamera = !coin(rng);
+        d.hasGPU = coin(rng);
+        d.lockedGPU = !coin(rng);
+        d.lockedFly = !coin(rng);
+        c.nodes.push_back(d);
+
+        c.x.push_back(d.coordX); c.y.push_back(d.coordY);
+        c.cpuAct.push_back(d.compActUsage); c.cpuMax.push_back(d.compMaxUsage);
+        c.memAct.push_back(d.memoryActUsage); c.memMax.push_back(d.memoryMaxUsage);
+        c.cam.push_back(d.hasCamera); c.lkCam.push_back(d.lockedCamera);
+        c.gpu.push_back(d.hasGPU); c.lkGpu.push_back(d.lockedGPU); c.lkFly.push_back(d.lockedFly);
+    }
+}
+
+// same shape as SimpleBroadcast1Hop::parseTask()
+TaskRequirements makeTask()
+{
+    TaskRequirements req;
+    req.reqPosition = true;
+    req.posX = 1200;
+    req.posY = 1300;
+    req.range = 630;
+    req.reqCamera = true;
+    req.reqGPU = true;
+    req.reqCPU = 3;
+    req.reqMemory = 2;
+    return req;
+}
+
+// ---- synthetic node table, with the lookup structure of NodeTable ----
+
+struct BenchData
+{
+    double timestamp = 0;
+    double coord_x = 0;
+    double coord_y = 0;
+    double compActUsage = 0;
+    double memoryActUsage = 0;
+    uint32_t nextHop_address = 0;
+    int num_hops = 0;
+};
+
+struct BenchTable
+{
+    std::unordered_map<uint32_t, int> slotOf;
+    std::vector<int> orderedSlots;
+    std::vector<uint32_t> keys;
+    std::vector<BenchData> rows;
+
+    int seek(uint32_t key, size_t& cursor) const {
+        if (cursor > 0 && !(keys[orderedSlots[cursor - 1]] < key)) {
+            auto it = slotOf.find(key);
+            return it == slotOf.end() ? -1 : it->second;
+        }
+        while (cursor < orderedSlots.size() && keys[orderedSlots[cursor]] < key)
+            ++cursor;
+        if (cursor < orderedSlots.size() && keys[orderedSlots[cursor]] == key)
+            return orderedSlots[cursor++];
+        return -1;
+    }
+    double getTimestamp(int slot) const { return rows[slot].timestamp; }
+    int getNumHops(int slot) const { return rows[slot].num_hops; }
+    uint32_t getNextHop(int slot) const { return rows[slot].nextHop_address; }
+    void set(int slot, const BenchData& data) { rows[slot] = data; }
+    int upsert(uint32_t key, const BenchData& data) {
+        int slot = keys.size();
+        slotOf[key] = slot;
+        keys.push_back(key);
+        rows.push_back(data);
+        auto pos = std::lower_bound(orderedSlots.begin(), orderedSlots.end(), key,
+                [this](int s, uint32_t k) { return keys[s] < k; });
+        orderedSlots.insert(pos, slot);
+        return slot;
+    }
+};
+
+struct BenchEntry
+{
+    uint32_t key;
+    double timestamp;
+    int numHops;
+    double coordX, coordY, compActUsage, memoryActUsage;
+};
+
+struct BenchList
+{
+    typedef BenchData Data;
+    std::vector<BenchEntry> entries;
+
+    size_t size() const { return entries.size(); }
+    const uint32_t& key(size_t i) const { return entries[i].key; }
+    double timestamp(size_t i) const { return entries[i].timestamp; }
+    int numHops(size_t i) const { return entries[i].numHops; }
+    void read(size_t i, BenchData& data) const {
+        const BenchEntry& e = entries[i];
+        data.timestamp = e.timestamp;
+        data.coord_x = e.coordX;
+        data.coord_y = e.coordY;
+        data.compActUsage = e.compActUsage;
+        data.memoryActUsage = e.memoryActUsage;
+    }
+};
+
+// local table of n nodes, neighbour list of n entries: 59% newer, 40% stale, 1% new nodes
+void makeMergeInput(int n, std::mt19937_64& rng, BenchTable& table, BenchList& list)
+{
+    std::uniform_real_distribution<double> u(0, 1);
+    std::uniform_int_distribution<int> hops(1, 6);
+
+    for (int i = 0; i < n; ++i) {
+        BenchData d;
+        d.timestamp = 100;
+        d.num_hops = hops(rng);
+        d.nextHop_address = 7;
+        table.upsert(2 * (uint32_t)i, d);
+    }
+    for (int i = 0; i < n; ++i) {
+        double r = u(rng);
+        BenchEntry e = BenchEntry();
+        e.key = (r < 0.01) ? 2 * (uint32_t)i + 1 : 2 * (uint32_t)i;
+        e.timestamp = (r < 0.60) ? 110 : 90;
+        e.numHops = hops(rng);
+        e.coordX = 1000 * u(rng);
+        e.coordY = 1000 * u(rng);
+        list.entries.push_back(e);
+    }
+}
+
+// ---- measurements ----
+
+struct Metric
+{
+    std::string name;
+    double ns;
+};
+
+std::vector<Metric> metrics;
+long sink = 0;
+
+void record(const std::string& name, int n, double ns)
+{
+    metrics.push_back({name + "/" + std::to_string(n), ns});
+}
+
+template<typename F>
+double bestOf(F&& run)
+{
+    double best = 1e300;
+    for (int r = 0; r < RUNS; ++r)
+        best = std::min(best, run());
+    return best;
+}
+
+bool runSize(int n, std::mt19937_64& rng)
+{
+    Candidates cand;
+    makeCandidates(n, rng, cand);
+    CandidateColumns view = cand.view();
+    TaskRequirements req = makeTask();
+    double ox = 1000, oy = 900, alpha = 90;
+    const int iters = std::max(5, 2000000 / n);
+
+    std::vector<uint8_t> refFeasible(n);
+    std::vector<double> refScores(n);
+    std::vector<uint64_t> mask;
+    std::vector<double> scores;
+
+    // ns per candidate
+    double feasScalar = bestOf([&] {
+        double t0 = nowNs();
+        for (int it = 0; it < iters; ++it) {
+            for (int i = 0; i < n; ++i)
+                refFeasible[i] = DecisionEngine::isDeployFeasible(req, cand.nodes[i]);
+            sink += refFeasible[it % n];
+        }
+        return (nowNs() - t0) / ((double)iters * n);
+    });
+    double feasBatch = bestOf([&] {
+        double t0 = nowNs();
+        for (int it = 0; it < iters; ++it) {
+            CandidateEvaluator::evaluateFeasibility(req, view, mask);
+            sink += mask[0] & 1;
+        }
+        return (nowNs() - t0) / ((double)iters * n);
+    });
+    double scoreScalar = bestOf([&] {
+        double t0 = nowNs();
+        for (int it = 0; it < iters; ++it) {
+            for (int i = 0; i < n; ++i)
+                refScores[i] = DecisionEngine::progressiveScore(req, cand.nodes[i], ox, oy, alpha);
+            sink += refScores[it % n] > 0.5;
+        }
+        return (nowNs() - t0) / ((double)iters * n);
+    });
+    double scoreBatch = bestOf([&] {
+        double t0 = nowNs();
+        for (int it = 0; it < iters; ++it) {
+            CandidateEvaluator::evaluateProgressiveScores(req, view, ox, oy, alpha, scores);
+            sink += scores[0] > 0.5;
+        }
+        return (nowNs() - t0) / ((double)iters * n);
+    });
+
+    // the batch path must agree with the per-node one
+    int mismatches = 0;
+    for (int i = 0; i < n; ++i) {
+        if ((bool)refFeasible[i] != CandidateEvaluator::isFeasible(mask, i))
+            mismatches++;
+        if (std::fabs(refScores[i] - scores[i]) > 1e-9)
+            mismatches++;
+    }
+
+    // whole decision, as in checkDeployDestination() on a cache miss: one draw
+    // (EXISTS) and all candidates (FORALL) alternate
+    std::vector<int> feasible, dests;
+    double decision = bestOf([&] {
+        double t0 = nowNs();
+        for (int it = 0; it < iters; ++it) {
+            CandidateEvaluator::evaluateFeasibility(req, view, mask);
+            feasible.clear();
+            for (int i = 0; i < n; ++i)
+                if (CandidateEvaluator::isFeasible(mask, i))
+                    feasible.push_back(i);
+            dests.clear();
+            DecisionEngine::selectAmong(feasible, it & 1,
+                    [&](int k) { return std::uniform_int_distribution<int>(0, k - 1)(rng); }, dests);
+            sink += dests.size();
+        }
+        return (nowNs() - t0) / iters;
+    });
+
+    // table merge, ns per list entry
+    BenchTable baseTable;
+    BenchList list;
+    makeMergeInput(n, rng, baseTable, list);
+    const int mergeIters = std::max(3, 200000 / n);
+    int taken = 0;
+    double merge = bestOf([&] {
+        double total = 0;
+        for (int it = 0; it < mergeIters; ++it) {
+            BenchTable table = baseTable;
+            double t0 = nowNs();
+            taken = DecisionEngine::mergeSortedList(table, list, (uint32_t)3, (uint32_t)5, (uint32_t)0xffffffff);
+            total += nowNs() - t0;
+            sink += table.rows.size();
+        }
+        return total / ((double)mergeIters * n);
+    });
+
+    record("feasibility.pernode", n, feasScalar);
+    record("feasibility.batch", n, feasBatch);
+    record("score.pernode", n, scoreScalar);
+    record("score.batch", n, scoreBatch);
+    record("decision", n, decision);
+    record("merge", n, merge);
+
+    printf("%6d nodes | ns/candidate: feasibility %6.2f per-node, %5.2f batch; score %6.2f per-node, %5.2f batch"
+           " | %9.0f decisions/s | merge %6.2f M entries/s (%d taken) | mismatches %d (%ld)\n",
+            n, feasScalar, feasBatch, scoreScalar, scoreBatch, 1e9 / decision, 1e3 / merge, taken, mismatches, sink & 1);
+    return mismatches == 0;
+}
+
+bool readBaseline(const char *file, std::map<std::string, double>& out)
+{
+    FILE *f = fopen(file, "r");
+    if (!f)
+        return false;
+    char line[256], name[200];
+    double ns;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#')
+            continue;
+        if (sscanf(line, "%199s %lf", name, &ns) == 2)
+            out[name] = ns;
+    }
+    fclose(f);
+    return true;
+}
+
+bool writeBaseline(const char *file)
+{
+    FILE *f = fopen(file, "w");
+    if (!f)
+        return false;
+    fprintf(f, "# DecisionEngineBench costs, ns per item (candidate, decision or merged entry)\n");
+    for (auto& m : metrics)
+        fprintf(f, "%s %.3f\n", m.name.c_str(), m.ns);
+    fclose(f);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *baselineFile = nullptr;
+    const char *outFile = nullptr;
+    double tolerance = 0.25;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            baselineFile = argv[++i];
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            outFile = argv[++i];
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [-w file] [-b file] [-t tolerance]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937_64 rng(42);
+    bool ok = true;
+    for (int n : {100, 1000, 10000, 100000})
+        ok &= runSize(n, rng);
+    if (!ok) {
+        fprintf(stderr, "batch and per-node results differ\n");
+        return 1;
+    }
+
+    if (outFile) {
+        if (!writeBaseline(outFile)) {
+            fprintf(stderr, "cannot write %s\n", outFile);
+            return 2;
+        }
+        printf("costs written to %s\n", outFile);
+    }
+
+    if (baselineFile) {
+        std::map<std::string, double> baseline;
+        if (!readBaseline(baselineFile, baseline)) {
+            fprintf(stderr, "cannot read %s\n", baselineFile);
+            return 2;
+        }
+        int regressions = 0;
+        printf("\n%-28s %10s %10s %8s\n", "metric (ns)", "baseline", "now", "change");
+        for (auto& m : metrics) {
+            auto it = baseline.find(m.name);
+            if (it == baseline.end()) {
+                printf("%-28s %10s %10.3f %8s\n", m.name.c_str(), "-", m.ns, "new");
+                continue;
+            }
+            double change = m.ns / it->second - 1;
+            bool regressed = change > tolerance;
+            regressions += regressed;
+            printf("%-28s %10.3f %10.3f %+7.1f%%%s\n", m.name.c_str(), it->second, m.ns, 100 * change,
+                    regressed ? "  REGRESSION" : "");
+        }
+        if (regressions > 0) {
+            printf("%d of %zu metrics more than %.0f%% slower than %s\n", regressions, metrics.size(), 100 * tolerance, baselineFile);
+            return 1;
+        }
+        printf("no metric more than %.0f%% slower than %s\n", 100 * tolerance, baselineFile);
+    }
+    return 0;
+}
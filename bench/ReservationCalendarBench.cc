@@ -0,0 +1,239 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+// Checks ReservationCalendar against a brute-force step function over random
+// reservations, queries and advances, then times peak() against the scan.
+// Exits with 1 on any mismatch.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ReservationCalendar.h"
+
+using namespace inet;
+
+namespace {
+
+typedef ReservationCalendar::Load Load;
+const int N = ReservationCalendar::NUM_RESOURCES;
+
+double nowNs()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Reservation
+{
+    double start, end;
+    Load load;
+};
+
+// the reference: a list of reservations, every query scans all of them
+struct BruteForce
+{
+    std::vector<Reservation> reservations;
+
+    void reserve(double start, double end, const Load& load) {
+        if (end > start)
+            reservations.push_back(Reservation{start, end, load});
+    }
+    // ended reservations no longer matter for t >= now
+    void advance(double now) {
+        reservations.erase(std::remove_if(reservations.begin(), reservations.end(),
+                [now](const Reservation& r) { return r.end <= now; }), reservations.end());
+    }
+    Load at(double t) const {
+        Load load;
+        for (const auto& r : reservations)
+            if (r.start <= t && t < r.end)
+                for (int k = 0; k < N; ++k)
+                    load[k] += r.load[k];
+        return load;
+    }
+    // change points in (from, to), sorted and distinct
+    std::vector<double> changes(double from, double to) const {
+        std::vector<double> times;
+        for (const auto& r : reservations) {
+            if (r.start > from && r.start < to)
+                times.push_back(r.start);
+            if (r.end > from && r.end < to)
+                times.push_back(r.end);
+        }
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+        return times;
+    }
+    Load peak(double start, double end) const {
+        Load best = at(start);
+        for (double t : changes(start, end)) {
+            Load load = at(t);
+            for (int k = 0; k < N; ++k)
+                best[k] = std::max(best[k], load[k]);
+        }
+        return best;
+    }
+    double nextChange(double t) const {
+        std::vector<double> times = changes(t, INFINITY);
+        return times.empty() ? INFINITY : times[0];
+    }
+    void steps(double from, int max, std::vector<std::pair<double, Load>>& out) const {
+        if (max <= 0)
+            return;
+        out.push_back(std::make_pair(from, at(from)));
+        for (double t : changes(from, INFINITY)) {
+            if ((int)out.size() == max)
+                break;
+            out.push_back(std::make_pair(t, at(t)));
+        }
+    }
+};
+
+Load randomLoad(std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<int> tenths(0, 40);
+    std::bernoulli_distribution lock(0.2);
+    Load load;
+    load[ReservationCalendar::CPU] = tenths(rng) * 0.1;
+    load[ReservationCalendar::MEMORY] = tenths(rng) * 0.1;
+    load[ReservationCalendar::GPU] = lock(rng);
+    load[ReservationCalendar::CAMERA] = lock(rng);
+    load[ReservationCalendar::FLY] = lock(rng);
+    return load;
+}
+
+bool sameLoad(const Load& a, const Load& b)
+{
+    for (int k = 0; k < N; ++k)
+        if (std::fabs(a[k] - b[k]) > 1e-6)
+            return false;
+    return true;
+}
+
+int mismatches = 0;
+
+void expect(bool ok, const char *what, int round)
+{
+    if (!ok && mismatches++ < 10)
+        printf("mismatch in %s at round %d\n", what, round);
+}
+
+// random reservations ahead of a moving now, on a coarse time grid so that
+// change points often coincide
+void check(std::mt19937_64& rng, int rounds)
+{
+    ReservationCalendar calendar;
+    BruteForce reference;
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_int_distribution<int> grid(0, 40);
+    double now = 0;
+    size_t maxSize = 0;
+
+    for (int round = 0; round < rounds; ++round) {
+        for (int i = std::uniform_int_distribution<int>(0, 3)(rng); i > 0; --i) {
+            double start = now + grid(rng) * 0.25;
+            double end = start + grid(rng) * 0.25; // empty reservations included
+            Load load = randomLoad(rng);
+            calendar.reserve(start, end, load);
+            reference.reserve(start, end, load);
+        }
+
+        double a = now + grid(rng) * 0.25 + (unit(rng) < 0.5 ? 0 : unit(rng));
+        double b = a + grid(rng) * 0.25 + (unit(rng) < 0.5 ? 0 : unit(rng));
+        expect(sameLoad(calendar.at(a), reference.at(a)), "at", round);
+        expect(sameLoad(calendar.peak(a, b), reference.peak(a, b)), "peak", round);
+        expect(calendar.nextChange(a) == reference.nextChange(a), "nextChange", round);
+
+        int max = std::uniform_int_distribution<int>(0, 6)(rng);
+        std::vector<std::pair<double, Load>> got, want;
+        calendar.steps(now, max, got);
+        reference.steps(now, max, want);
+        bool same = got.size() == want.size();
+        for (size_t i = 0; same && i < got.size(); ++i)
+            same = got[i].first == want[i].first && sameLoad(got[i].second, want[i].second);
+        expect(same, "steps", round);
+
+        if (unit(rng) < 0.3) {
+            now += grid(rng) * 0.25 * unit(rng);
+            calendar.advance(now);
+            reference.advance(now);
+            expect(sameLoad(calendar.at(now), reference.at(now)), "advance", round);
+            // folding keeps at most one point at or before now, plus two per pending reservation
+            expect(calendar.size() <= 1 + 2 * (int)reference.reservations.size(), "advance size", round);
+        }
+        maxSize = std::max(maxSize, (size_t)calendar.size());
+    }
+    printf("%d random rounds, largest calendar %zu change points\n", rounds, maxSize);
+}
+
+// peak() of a task lifetime with n pending reservations
+void timePeak(std::mt19937_64& rng, int n)
+{
+    ReservationCalendar calendar;
+    BruteForce reference;
+    std::uniform_real_distribution<double> time(0, 1000);
+    std::uniform_real_distribution<double> length(1, 50);
+    for (int i = 0; i < n; ++i) {
+        double start = time(rng);
+        Load load = randomLoad(rng);
+        double end = start + length(rng);
+        calendar.reserve(start, end, load);
+        reference.reserve(start, end, load);
+    }
+
+    const int queries = 1000;
+    std::vector<double> starts(queries), ends(queries);
+    for (int i = 0; i < queries; ++i) {
+        starts[i] = time(rng);
+        ends[i] = starts[i] + length(rng);
+    }
+
+    double sink = 0;
+    int refIters = std::max(1, 20000 / n);
+    double t0 = nowNs();
+    for (int it = 0; it < refIters; ++it)
+        for (int i = 0; i < queries; ++i)
+            sink += reference.peak(starts[i], ends[i])[ReservationCalendar::CPU];
+    double tRef = (nowNs() - t0) / ((double)refIters * queries);
+
+    int iters = 200;
+    t0 = nowNs();
+    for (int it = 0; it < iters; ++it)
+        for (int i = 0; i < queries; ++i)
+            sink += calendar.peak(starts[i], ends[i])[ReservationCalendar::CPU];
+    double tCal = (nowNs() - t0) / ((double)iters * queries);
+
+    printf("%6d reservations | peak: scan %9.1f ns, calendar %6.1f ns, speedup %7.1fx (%d)\n",
+            n, tRef, tCal, tRef / tCal, (int)sink & 1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::mt19937_64 rng(42);
+    check(rng, 20000);
+    timePeak(rng, 100);
+    timePeak(rng, 1000);
+    timePeak(rng, 10000);
+    if (mismatches != 0) {
+        printf("%d mismatches\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,288 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+// Counts heap allocations per forwarded task on a model of the
+// SimpleBroadcast1Hop send path: tasks copied by value into every queue and
+// vectors built per task, against shared immutable tasks and pooled dest/ttl
+// vectors. The module needs OMNeT++, so this is not the module code: TaskREQ,
+// L3Address and the message are replaced by plain structs of the same size,
+// and SharedPath repeats the bookkeeping of forwardTask() and of the ACK
+// handler (ackEntries, ackIndex, ackDeadlines). Keep it in step with them.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "VectorPool.h"
+
+using namespace inet;
+
+namespace {
+
+long numAllocs = 0;
+
+} // namespace
+
+void *operator new(size_t size)
+{
+    ++numAllocs;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// same size as TaskREQ (simtime_t and L3Address replaced by same-size fields)
+struct Task
+{
+    uint64_t gen_ipAddress[2];
+    uint32_t id;
+    int64_t gen_timestamp;
+    uint8_t hops_to_deploy;
+    int strategy, devType;
+    int64_t start_timestamp, end_timestamp;
+    bool reqPosition;
+    double pos_coord_x, pos_coord_y, range;
+    bool req_lock_flyengine, reqCamera, lockCamera, reqGPU, lockGPU;
+    double reqCPU, reqMemory;
+};
+
+typedef uint64_t Address;
+typedef std::tuple<Address, Address, int> DestNextTtl;
+
+// stand-in for TaskREQmessage: the task and the destination details
+struct Payload
+{
+    Task task;
+    std::vector<DestNextTtl> destDetail;
+};
+
+const int numDests = 3;
+
+// Previous path: Forwarding_Task holds a TaskREQ, queue and ACK list take copies
+struct CopyingPath
+{
+    struct Forwarding_Task { std::vector<Address> dests; Task task; std::vector<int> ttls; unsigned numberOfSending; };
+    struct Ack_Forwarding_Task { Forwarding_Task ft; std::vector<bool> acked; };
+
+    std::vector<Task> generatedTask_list;
+    std::queue<Forwarding_Task> forwardingTask_queue;
+    std::unordered_map<long, Ack_Forwarding_Task> ackEntries;
+    long nextEntryId = 0;
+
+    void generate(const Task& proto) {
+        Task newTask = proto;
+        generatedTask_list.push_back(newTask);
+        manageNewTask(newTask);
+    }
+    void manageNewTask(Task& task) {
+        std::vector<Address> deployDest_out;
+        std::vector<int> ttls;
+        for (int i = 0; i < numDests; ++i) {
+            deployDest_out.push_back(100 + i);
+            ttls.push_back(10);
+        }
+        Forwarding_Task ft;
+        ft.dests = deployDest_out;
+        ft.task = task;
+        ft.ttls = ttls;
+        ft.numberOfSending = 0;
+        forwardingTask_queue.push(ft);
+    }
+    std::shared_ptr<Payload> forward() {
+        Forwarding_Task& frontTask = forwardingTask_queue.front();
+        std::vector<DestNextTtl> dest_next_ttl;
+        for (size_t i = 0; i < frontTask.dests.size(); ++i)
+            dest_next_ttl.push_back(std::make_tuple(frontTask.dests[i], frontTask.dests[i], frontTask.ttls[i]));
+        auto payload = std::make_shared<Payload>();
+        payload->task = frontTask.task;
+        payload->destDetail = dest_next_ttl;
+
+        Ack_Forwarding_Task& aft = ackEntries[nextEntryId++];
+        aft.ft = frontTask;
+        aft.acked.assign(frontTask.dests.size(), false);
+        forwardingTask_queue.pop();
+        return payload;
+    }
+    void acked() { ackEntries.clear(); }
+};
+
+// Current path: shared immutable tasks, pooled vectors moved between the
+// queues, ACKs found through ackIndex and expiries kept in ackDeadlines
+struct SharedPath
+{
+    typedef std::shared_ptr<const Task> TaskPtr;
+    struct Forwarding_Task { std::vector<Address> dests; TaskPtr task; std::vector<int> ttls; unsigned numberOfSending; };
+    struct Ack_Forwarding_Task { Forwarding_Task ft; std::vector<bool> acked; int numPending; int64_t sendingTimestamp; };
+    struct AckKey {
+        Address gen;
+        uint32_t id;
+        Address dest;
+        bool operator==(const AckKey& o) const { return id == o.id && gen == o.gen && dest == o.dest; }
+    };
+    struct AckKeyHash {
+        size_t operator()(const AckKey& k) const { return (std::hash<Address>()(k.gen) * 31 + k.id) * 31 + std::hash<Address>()(k.dest); }
+    };
+    typedef std::pair<int64_t, long> AckDeadline;
+
+    std::queue<Forwarding_Task> forwardingTask_queue;
+    long nextAckEntryId = 0;
+    std::unordered_map<long, Ack_Forwarding_Task> ackEntries;
+    std::unordered_map<AckKey, std::vector<std::pair<long, int>>, AckKeyHash> ackIndex;
+    std::priority_queue<AckDeadline, std::vector<AckDeadline>, std::greater<AckDeadline>> ackDeadlines;
+    VectorPool<Address> destPool;
+    VectorPool<int> ttlPool;
+    std::vector<DestNextTtl> destNextTtl;
+    std::vector<AckKey> sent; // the ACKs to deliver in acked()
+    int64_t now = 0;
+
+    void generate(const Task& proto) {
+        manageNewTask(std::make_shared<const Task>(proto));
+    }
+    void manageNewTask(const TaskPtr& task) {
+        std::vector<Address> deployDest_out = destPool.acquire();
+        std::vector<int> ttls = ttlPool.acquire();
+        for (int i = 0; i < numDests; ++i) {
+            deployDest_out.push_back(100 + i);
+            ttls.push_back(10);
+        }
+        Forwarding_Task ft;
+        ft.dests = std::move(deployDest_out);
+        ft.task = task;
+        ft.ttls = std::move(ttls);
+        ft.numberOfSending = 0;
+        forwardingTask_queue.push(std::move(ft));
+    }
+    void releaseForwarding(Forwarding_Task& ft) {
+        destPool.release(ft.dests);
+        ttlPool.release(ft.ttls);
+    }
+    std::shared_ptr<Payload> forward() {
+        Forwarding_Task& frontTask = forwardingTask_queue.front();
+        destNextTtl.clear();
+        for (size_t i = 0; i < frontTask.dests.size(); ++i)
+            destNextTtl.emplace_back(frontTask.dests[i], frontTask.dests[i], frontTask.ttls[i]);
+        auto payload = std::make_shared<Payload>();
+        payload->task = *frontTask.task;
+        payload->destDetail = destNextTtl;
+
+        long entryId = nextAckEntryId++;
+        Ack_Forwarding_Task& aft = ackEntries[entryId];
+        aft.ft = std::move(frontTask);
+        aft.ft.numberOfSending += 1;
+        aft.acked.assign(aft.ft.dests.size(), false);
+        aft.numPending = aft.ft.dests.size();
+        aft.sendingTimestamp = ++now;
+        const Task& task = *aft.ft.task;
+        for (size_t i = 0; i < aft.ft.dests.size(); ++i) {
+            AckKey key{task.gen_ipAddress[0], task.id, aft.ft.dests[i]};
+            ackIndex[key].push_back(std::make_pair(entryId, (int)i));
+            sent.push_back(key);
+        }
+        ackDeadlines.push(std::make_pair(aft.sendingTimestamp + 3, entryId));
+        skipAckedDeadlines();
+        forwardingTask_queue.pop();
+        return payload;
+    }
+    // one ACK per destination, as in processTaskREQ_ACKmessage()
+    void acked() {
+        for (const AckKey& key : sent) {
+            auto idx = ackIndex.find(key);
+            if (idx == ackIndex.end())
+                continue;
+            std::vector<std::pair<long, int>>& refs = idx->second;
+            long lastEntry = -1;
+            for (size_t k = refs.size(); k-- > 0; ) {
+                if (refs[k].first == lastEntry)
+                    continue;
+                lastEntry = refs[k].first;
+                Ack_Forwarding_Task& aft = ackEntries.at(lastEntry);
+                aft.acked[refs[k].second] = true;
+                if (--aft.numPending == 0) {
+                    releaseForwarding(aft.ft);
+                    ackEntries.erase(lastEntry);
+                }
+                refs[k].first = -1;
+            }
+            refs.erase(std::remove_if(refs.begin(), refs.end(), [](const std::pair<long, int>& r) { return r.first < 0; }), refs.end());
+            if (refs.empty())
+                ackIndex.erase(idx);
+            skipAckedDeadlines();
+        }
+        sent.clear();
+    }
+    // the pop loop of rescheduleAckTimer()
+    void skipAckedDeadlines() {
+        while (!ackDeadlines.empty() && ackEntries.count(ackDeadlines.top().second) == 0)
+            ackDeadlines.pop();
+    }
+};
+
+double nowNs()
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// tasks go through generate -> queue -> send -> ACK list -> acknowledged, in bursts
+template<typename Path>
+double run(const char *name, int numTasks, int burst)
+{
+    Path path;
+    Task proto = Task();
+    proto.reqCPU = 3;
+    proto.reqMemory = 2;
+
+    long sink = 0;
+    long allocs0 = numAllocs;
+    double t0 = nowNs();
+    for (int done = 0; done < numTasks; done += burst) {
+        for (int i = 0; i < burst; ++i) {
+            proto.id = done + i;
+            path.generate(proto);
+        }
+        for (int i = 0; i < burst; ++i)
+            sink += path.forward()->destDetail.size();
+        path.acked();
+    }
+    double ns = (nowNs() - t0) / numTasks;
+    double perTask = (double)(numAllocs - allocs0) / numTasks;
+    printf("%-8s | %5.2f allocations per forwarded task | %7.1f ns per task (%ld)\n", name, perTask, ns, sink & 1);
+    return perTask;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const int numTasks = 200000, burst = 16;
+    double copying = run<CopyingPath>("copying", numTasks, burst);
+    double shared = run<SharedPath>("shared", numTasks, burst);
+    printf("allocations per forwarded task: %.2f -> %.2f\n", copying, shared);
+    return 0;
+}
@@ -0,0 +1,61 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_BROADCASTLOG_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_BROADCASTLOG_H_
+
+#include <cstdio>
+#include <cstdarg>
+
+#include "inet/common/INETDefs.h"
+
+/*
+ * Logging switches of the broadcastwireless sources.
+ *
+ * BROADCASTWIRELESS_LOGLEVEL overrides the OMNeT++ compile-time log level for
+ * these sources only (e.g. -DBROADCASTWIRELESS_LOGLEVEL=omnetpp::LOGLEVEL_WARN,
+ * see "make sweep"): EV_INFO and below then compile to nothing.
+ *
+ * EV_INFO still evaluates its arguments when logging is disabled at runtime
+ * (Cmdenv express mode), so the per-packet dumps are additionally wrapped in
+ * BW_LOG_DETAIL, which is a compile-time constant false when the level
+ * excludes INFO and a single runtime check otherwise.
+ */
+#ifdef BROADCASTWIRELESS_LOGLEVEL
+#undef COMPILETIME_LOGLEVEL
+#define COMPILETIME_LOGLEVEL BROADCASTWIRELESS_LOGLEVEL
+#endif
+
+#define BW_LOG_DETAIL (omnetpp::LOGLEVEL_INFO >= COMPILETIME_LOGLEVEL && omnetpp::getEnvir()->isLoggingEnabled())
+
+/*
+ * printf-style tracing to stdout, compiled in only with -DBROADCASTWIRELESS_DEBUGPRINT.
+ * Otherwise the call and its arguments disappear.
+ */
+#ifdef BROADCASTWIRELESS_DEBUGPRINT
+static inline void debugPrint(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    fflush(stdout);
+}
+#else
+#define debugPrint(...) ((void)0)
+#endif
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_BROADCASTLOG_H_ */
@@ -0,0 +1,199 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "CandidateEvaluator.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace inet {
+
+namespace {
+
+// task-wide terms of the feasibility test, hoisted out of the candidate loops
+struct FeasibilityTerms
+{
+    bool reqPos, reqGPU, reqCam, reqFly;
+    double px, py, r2, reqCPU, reqMem;
+
+    FeasibilityTerms(const TaskRequirements& req) :
+        reqPos(req.reqPosition), reqGPU(req.reqGPU), reqCam(req.reqCamera), reqFly(req.reqLockFly),
+        px(req.posX), py(req.posY), r2(req.range * req.range), reqCPU(req.reqCPU), reqMem(req.reqMemory) {}
+
+    bool feasible(const CandidateColumns& nodes, int i) const {
+        double dx = nodes.coordX[i] - px;
+        double dy = nodes.coordY[i] - py;
+
+        bool ok = ((!reqPos) | (dx * dx + dy * dy <= r2));
+        ok &= ((!reqGPU) | (nodes.hasGPU[i] & !nodes.lockedGPU[i]));
+        ok &= ((!reqFly) | !nodes.lockedFly[i]);
+        ok &= ((!reqCam) | (nodes.hasCamera[i] & !nodes.lockedCamera[i]));
+        ok &= (reqCPU + nodes.compActUsage[i] <= nodes.compMaxUsage[i]);
+        ok &= (reqMem + nodes.memoryActUsage[i] <= nodes.memoryMaxUsage[i]);
+        return ok;
+    }
+};
+
+// task-wide terms of the progressive score
+struct ScoreTerms
+{
+    bool reqPos, reqGPU, reqCam, reqFly;
+    double originX, originY, ADx, ADy, magAD2, alphaRad, cosAlpha, reqCPU, reqMem;
+
+    ScoreTerms(const TaskRequirements& req, double ox, double oy, double alphaDegrees) :
+        reqPos(req.reqPosition), reqGPU(req.reqGPU), reqCam(req.reqCamera), reqFly(req.reqLockFly),
+        originX(ox), originY(oy), reqCPU(req.reqCPU), reqMem(req.reqMemory)
+    {
+        // vector from the origin to the task position, the same for all candidates
+        ADx = req.posX - originX;
+        ADy = req.posY - originY;
+        magAD2 = ADx * ADx + ADy * ADy;
+        alphaRad = alphaDegrees * M_PI / 180.0;
+        cosAlpha = std::cos(alphaRad);
+    }
+
+    double positionFactor(const CandidateColumns& nodes, int i) const {
+        double pos_fact = 1;
+        if (reqPos) {
+            double ABx = nodes.coordX[i] - originX;
+            double ABy = nodes.coordY[i] - originY;
+            double magAB2 = ABx * ABx + ABy * ABy;
+            double dot = ADx * ABx + ADy * ABy;
+
+            // zero-length vectors: angle undefined, same as directionFactor()
+            if (magAD2 < 1e-18 || magAB2 < 1e-18) {
+                pos_fact = 0;
+            }
+            else {
+                // theta >= alpha  <=>  cos(theta) <= cos(alpha)
+                bool outside;
+                if (cosAlpha >= 0)
+                    outside = (dot <= 0) || (dot * dot <= cosAlpha * cosAlpha * magAD2 * magAB2);
+                else
+                    outside = (dot < 0) && (dot * dot >= cosAlpha * cosAlpha * magAD2 * magAB2);
+
+                if (outside) {
+                    pos_fact = 0;
+                }
+                else {
+                    double cosTheta = dot / std::sqrt(magAD2 * magAB2);
+                    cosTheta = std::max(-1.0, std::min(1.0, cosTheta));
+                    pos_fact = 1.0 - std::acos(cosTheta) / alphaRad;
+                }
+            }
+        }
+        return pos_fact;
+    }
+
+    double resourceFactor(const CandidateColumns& nodes, int i) const {
+        double gpu_fact = (reqGPU & (nodes.lockedGPU[i] | !nodes.hasGPU[i])) ? 0 : 1;
+        double fly_fact = (reqFly & nodes.lockedFly[i]) ? 0 : 1;
+        double cam_fact = (reqCam & (nodes.lockedCamera[i] | !nodes.hasCamera[i])) ? 0 : 1;
+
+        double cpuNeed = reqCPU + nodes.compActUsage[i];
+        double cpu_fact = (cpuNeed > nodes.compMaxUsage[i]) ? nodes.compMaxUsage[i] / cpuNeed : 1;
+        double memNeed = reqMem + nodes.memoryActUsage[i];
+        double mem_fact = (memNeed > nodes.memoryMaxUsage[i]) ? nodes.memoryMaxUsage[i] / memNeed : 1;
+
+        return (gpu_fact + fly_fact + cam_fact + cpu_fact + mem_fact) / 5.0;
+    }
+
+    static double combine(double pos_fact, double res_fact) { return (0.5 * pos_fact) + (0.5 * res_fact); }
+
+    double score(const CandidateColumns& nodes, int i) const {
+        return combine(positionFactor(nodes, i), resourceFactor(nodes, i));
+    }
+};
+
+} // namespace
+
+void CandidateEvaluator::evaluateFeasibility(const TaskRequirements& req, const CandidateColumns& nodes, std::vector<uint64_t>& mask)
+{
+    const int n = nodes.count;
+    mask.assign((n + 63) / 64, 0);
+
+    const FeasibilityTerms terms(req);
+    for (int base = 0; base < n; base += 64) {
+        const int lim = std::min(64, n - base);
+        uint64_t word = 0;
+        for (int j = 0; j < lim; ++j)
+            word |= (uint64_t)terms.feasible(nodes, base + j) << j;
+        mask[base >> 6] = word;
+    }
+}
+
+void CandidateEvaluator::updateFeasibility(const TaskRequirements& req, const CandidateColumns& nodes,
+        const std::vector<int>& slots, std::vector<uint64_t>& mask)
+{
+    mask.resize((nodes.count + 63) / 64, 0);
+
+    const FeasibilityTerms terms(req);
+    for (int i : slots)
+        setFeasible(mask, i, terms.feasible(nodes, i));
+}
+
+void CandidateEvaluator::evaluateProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+        double originX, double originY, double alphaDegrees, std::vector<double>& scores)
+{
+    const int n = nodes.count;
+    scores.resize(n);
+
+    const ScoreTerms terms(req, originX, originY, alphaDegrees);
+    for (int i = 0; i < n; ++i)
+        scores[i] = terms.score(nodes, i);
+}
+
+void CandidateEvaluator::updateProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+        double originX, double originY, double alphaDegrees, const std::vector<int>& slots, std::vector<double>& scores)
+{
+    scores.resize(nodes.count);
+
+    const ScoreTerms terms(req, originX, originY, alphaDegrees);
+    for (int i : slots)
+        scores[i] = terms.score(nodes, i);
+}
+
+void CandidateEvaluator::evaluateResourceFactors(const TaskRequirements& req, const CandidateColumns& nodes, std::vector<double>& factors)
+{
+    const int n = nodes.count;
+    factors.resize(n);
+
+    const ScoreTerms terms(req, 0, 0, 90);
+    for (int i = 0; i < n; ++i)
+        factors[i] = terms.resourceFactor(nodes, i);
+}
+
+void CandidateEvaluator::updateResourceFactors(const TaskRequirements& req, const CandidateColumns& nodes,
+        const std::vector<int>& slots, std::vector<double>& factors)
+{
+    factors.resize(nodes.count);
+
+    const ScoreTerms terms(req, 0, 0, 90);
+    for (int i : slots)
+        factors[i] = terms.resourceFactor(nodes, i);
+}
+
+void CandidateEvaluator::combineProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+        double originX, double originY, double alphaDegrees, const std::vector<int>& slots,
+        const std::vector<double>& resourceFactors, std::vector<double>& scores)
+{
+    scores.resize(nodes.count);
+
+    const ScoreTerms terms(req, originX, originY, alphaDegrees);
+    for (int i : slots)
+        scores[i] = ScoreTerms::combine(terms.positionFactor(nodes, i), resourceFactors[i]);
+}
+
+} // namespace inet
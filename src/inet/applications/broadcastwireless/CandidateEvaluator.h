@@ -0,0 +1,116 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_CANDIDATEEVALUATOR_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_CANDIDATEEVALUATOR_H_
+
+#include <cstdint>
+#include <vector>
+
+// NOTE: this file must not depend on OMNeT++/INET headers, it is also built by bench/
+
+namespace inet {
+
+/**
+ * Plain copy of the TaskREQ fields used by the placement checks.
+ */
+struct TaskRequirements
+{
+    bool reqPosition = false;
+    double posX = 0;
+    double posY = 0;
+    double range = 0;
+
+    bool reqLockFly = false;
+    bool reqCamera = false;
+    bool reqGPU = false;
+
+    double reqCPU = 0;
+    double reqMemory = 0;
+};
+
+/**
+ * Column view over a set of candidate nodes (see NodeTable::columns()).
+ */
+struct CandidateColumns
+{
+    int count = 0;
+    const double *coordX = nullptr;
+    const double *coordY = nullptr;
+    const double *compActUsage = nullptr;
+    const double *compMaxUsage = nullptr;
+    const double *memoryActUsage = nullptr;
+    const double *memoryMaxUsage = nullptr;
+    const uint8_t *hasCamera = nullptr;
+    const uint8_t *lockedCamera = nullptr;
+    const uint8_t *hasGPU = nullptr;
+    const uint8_t *lockedGPU = nullptr;
+    const uint8_t *lockedFly = nullptr;
+};
+
+/**
+ * Batch version of isDeployFeasible() and calculateProgressiveScore():
+ * evaluates one task against all candidates in a single branch-free pass
+ * over the columns.
+ */
+class CandidateEvaluator
+{
+  public:
+    /** Sets bit i of mask (64 candidates per word) when candidate i can host the task. */
+    static void evaluateFeasibility(const TaskRequirements& req, const CandidateColumns& nodes, std::vector<uint64_t>& mask);
+
+    /**
+     * Progressive score of every candidate, as seen from (originX, originY).
+     * The arc test is done on cosines; acos is only computed for candidates
+     * inside the arc, where the factor decreases linearly with the angle.
+     */
+    static void evaluateProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+            double originX, double originY, double alphaDegrees, std::vector<double>& scores);
+
+    /**
+     * Re-evaluates only the listed candidates, leaving the other bits/scores
+     * untouched; the output is grown to nodes.count if needed.
+     */
+    static void updateFeasibility(const TaskRequirements& req, const CandidateColumns& nodes,
+            const std::vector<int>& slots, std::vector<uint64_t>& mask);
+    static void updateProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+            double originX, double originY, double alphaDegrees, const std::vector<int>& slots, std::vector<double>& scores);
+
+    /**
+     * Resource part of the progressive score (GPU, fly engine, camera, CPU
+     * and memory factors), which does not depend on the task position.
+     */
+    static void evaluateResourceFactors(const TaskRequirements& req, const CandidateColumns& nodes, std::vector<double>& factors);
+    static void updateResourceFactors(const TaskRequirements& req, const CandidateColumns& nodes,
+            const std::vector<int>& slots, std::vector<double>& factors);
+
+    /**
+     * Progressive scores of the listed candidates from their resource factors,
+     * adding the direction factor of the task position; equal to
+     * evaluateProgressiveScores() for these candidates.
+     */
+    static void combineProgressiveScores(const TaskRequirements& req, const CandidateColumns& nodes,
+            double originX, double originY, double alphaDegrees, const std::vector<int>& slots,
+            const std::vector<double>& resourceFactors, std::vector<double>& scores);
+
+    static bool isFeasible(const std::vector<uint64_t>& mask, int i) { return (mask[i >> 6] >> (i & 63)) & 1; }
+    static void setFeasible(std::vector<uint64_t>& mask, int i, bool ok) {
+        mask[i >> 6] = (mask[i >> 6] & ~(1ULL << (i & 63))) | ((uint64_t)ok << (i & 63));
+    }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_CANDIDATEEVALUATOR_H_ */
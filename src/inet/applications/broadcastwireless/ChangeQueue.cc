@@ -0,0 +1,53 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "ChangeQueue.h"
+
+namespace inet {
+
+void ChangeQueue::pop()
+{
+    const Change& ch = changes.front();
+    auto it = index.find(Key{ch.getIpAddress(), ch.getParammeter()});
+    if (it != index.end() && it->second == frontPosition)
+        index.erase(it);
+
+    changes.pop_front();
+    frontPosition++;
+}
+
+void ChangeQueue::push(const Change& ch)
+{
+    index[Key{ch.getIpAddress(), ch.getParammeter()}] = frontPosition + changes.size();
+    changes.push_back(ch);
+}
+
+void ChangeQueue::merge(const Change& ch)
+{
+    auto it = index.find(Key{ch.getIpAddress(), ch.getParammeter()});
+    if (it == index.end()) {
+        push(ch);
+        return;
+    }
+
+    Change& pending = changes[it->second - frontPosition];
+    if (ch.getSequenceNumber() > pending.getSequenceNumber()) {
+        //update element
+        pending.setValue(ch.getValue());
+        pending.setSequenceNumber(ch.getSequenceNumber());
+    }
+}
+
+} // namespace inet
@@ -0,0 +1,74 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_CHANGEQUEUE_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_CHANGEQUEUE_H_
+
+#include <deque>
+#include <unordered_map>
+
+#include "NodeTable.h"
+#include "Heartbeat_m.h"
+
+namespace inet {
+
+/**
+ * FIFO of pending Change records for HIERARCHICAL_CHANGES, indexed by
+ * (address, field) so that coalescing a received change is O(1).
+ *
+ * Entries are identified by an absolute position (number of entries ever
+ * pushed before them), which stays valid while the front is popped.
+ */
+class INET_API ChangeQueue
+{
+  protected:
+    struct Key
+    {
+        L3Address address;
+        uint8_t field;
+        bool operator==(const Key& o) const { return field == o.field && address == o.address; }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& k) const { return L3AddressHash()(k.address) * 31 + k.field; }
+    };
+
+    std::deque<Change> changes;
+    uint64_t frontPosition = 0; // absolute position of changes.front()
+    std::unordered_map<Key, uint64_t, KeyHash> index; // latest entry of each (address, field)
+
+  public:
+    ChangeQueue() {}
+
+    int size() const { return changes.size(); }
+    bool empty() const { return changes.empty(); }
+    const Change& front() const { return changes.front(); }
+    /** The i-th pending change, from the front. */
+    const Change& at(int i) const { return changes[i]; }
+    void pop();
+
+    /** Appends the change without coalescing. */
+    void push(const Change& ch);
+    /**
+     * Coalesces the change into the pending entry with the same address and
+     * field (value and sequence number are replaced if it is newer), or
+     * appends it if there is none.
+     */
+    void merge(const Change& ch);
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_CHANGEQUEUE_H_ */
@@ -0,0 +1,174 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "DecisionCache.h"
+
+#include <algorithm>
+
+namespace inet {
+
+DecisionKey::DecisionKey(const TaskRequirements& req, bool progressive) :
+    reqLockFly(req.reqLockFly), reqCamera(req.reqCamera), reqGPU(req.reqGPU),
+    reqCPU(req.reqCPU), reqMemory(req.reqMemory), progressive(progressive)
+{
+}
+
+TaskRequirements DecisionKey::requirements() const
+{
+    TaskRequirements req;
+    req.reqLockFly = reqLockFly;
+    req.reqCamera = reqCamera;
+    req.reqGPU = reqGPU;
+    req.reqCPU = reqCPU;
+    req.reqMemory = reqMemory;
+    return req;
+}
+
+bool DecisionKey::operator==(const DecisionKey& o) const
+{
+    return reqLockFly == o.reqLockFly && reqCamera == o.reqCamera && reqGPU == o.reqGPU
+            && reqCPU == o.reqCPU && reqMemory == o.reqMemory && progressive == o.progressive;
+}
+
+size_t DecisionKeyHash::operator()(const DecisionKey& key) const
+{
+    std::hash<double> hd;
+    size_t h = (key.reqLockFly << 0) | (key.reqCamera << 1) | (key.reqGPU << 2) | (key.progressive << 3);
+    for (double v : { key.reqCPU, key.reqMemory })
+        h = h * 1000003 ^ hd(v);
+    return h;
+}
+
+const DecisionCache::Entry& DecisionCache::lookup(const NodeTable& table, const DecisionKey& key)
+{
+    if (maxEntries == 0) {
+        numMisses++;
+        evaluateAll(table, key, uncached);
+        return uncached;
+    }
+
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        // signatures are expected to repeat in bursts: start over rather than tracking recency
+        if (entries.size() >= maxEntries)
+            entries.clear();
+        it = entries.emplace(key, Entry()).first;
+        numMisses++;
+        evaluateAll(table, key, it->second);
+        return it->second;
+    }
+
+    Entry& entry = it->second;
+    if (entry.tableVersion == table.getVersion()) {
+        numHits++;
+        return entry;
+    }
+
+    changed.clear();
+    if (table.changedSince(entry.tableVersion, changed)) {
+        numUpdates++;
+        evaluateChanged(table, key, entry);
+    }
+    else {
+        numMisses++;
+        evaluateAll(table, key, entry);
+    }
+    return entry;
+}
+
+void DecisionCache::evaluateAll(const NodeTable& table, const DecisionKey& key, Entry& entry)
+{
+    CandidateColumns cols = table.columns();
+    entry.tableVersion = table.getVersion();
+
+    if (key.progressive) {
+        CandidateEvaluator::evaluateResourceFactors(key.requirements(), cols, entry.scores);
+        entry.candidates = table.slotsByAddress();
+        return;
+    }
+
+    CandidateEvaluator::evaluateFeasibility(key.requirements(), cols, entry.mask);
+
+    entry.candidates.clear();
+    for (int slot : table.slotsByAddress()) {
+        if (CandidateEvaluator::isFeasible(entry.mask, slot))
+            entry.candidates.push_back(slot);
+    }
+}
+
+void DecisionCache::evaluateChanged(const NodeTable& table, const DecisionKey& key, Entry& entry)
+{
+    CandidateColumns cols = table.columns();
+    entry.tableVersion = table.getVersion();
+
+    if (key.progressive) {
+        CandidateEvaluator::updateResourceFactors(key.requirements(), cols, changed, entry.scores);
+        if (entry.candidates.size() != table.slotsByAddress().size())
+            entry.candidates = table.slotsByAddress();
+        return;
+    }
+
+    // bits past the previous count are zero: new slots were not candidates
+    entry.mask.resize((cols.count + 63) / 64, 0);
+    wasFeasible.clear();
+    for (int slot : changed)
+        wasFeasible.push_back(CandidateEvaluator::isFeasible(entry.mask, slot));
+
+    CandidateEvaluator::updateFeasibility(key.requirements(), cols, changed, entry.mask);
+
+    auto byAddress = [&table](int a, int b) { return table.getAddress(a) < table.getAddress(b); };
+    for (size_t i = 0; i < changed.size(); ++i) {
+        int slot = changed[i];
+        bool isFeasible = CandidateEvaluator::isFeasible(entry.mask, slot);
+        if (isFeasible == (bool)wasFeasible[i])
+            continue;
+
+        auto pos = std::lower_bound(entry.candidates.begin(), entry.candidates.end(), slot, byAddress);
+        if (isFeasible)
+            entry.candidates.insert(pos, slot);
+        else
+            entry.candidates.erase(pos);
+    }
+}
+
+void DecisionCache::selectInCircle(const NodeTable& table, const Entry& entry, double x, double y, double range, std::vector<int>& out) const
+{
+    // same test as the feasibility check
+    const double *xs = table.coordX();
+    const double *ys = table.coordY();
+    double r2 = range * range;
+    auto inside = [&](int slot) {
+        double dx = xs[slot] - x;
+        double dy = ys[slot] - y;
+        return dx * dx + dy * dy <= r2;
+    };
+
+    out.clear();
+    if (!table.hasGrid()) {
+        // the candidates are already in address order
+        for (int slot : entry.candidates)
+            if (inside(slot))
+                out.push_back(slot);
+        return;
+    }
+
+    // the grid returns whole cells
+    table.queryCircle(x, y, range, out);
+    out.erase(std::remove_if(out.begin(), out.end(),
+            [&](int slot) { return !CandidateEvaluator::isFeasible(entry.mask, slot) || !inside(slot); }), out.end());
+    std::sort(out.begin(), out.end(), [&table](int a, int b) { return table.getAddress(a) < table.getAddress(b); });
+}
+
+} // namespace inet
@@ -0,0 +1,117 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONCACHE_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONCACHE_H_
+
+#include <vector>
+#include <unordered_map>
+
+#include "NodeTable.h"
+
+namespace inet {
+
+/**
+ * Requirement signature of a placement decision: the resource requirements
+ * of the task. The task position and the origin of the progressive scores
+ * are not part of it; they are applied to the cached decision by the caller.
+ */
+struct DecisionKey
+{
+    bool reqLockFly = false;
+    bool reqCamera = false;
+    bool reqGPU = false;
+    double reqCPU = 0;
+    double reqMemory = 0;
+
+    bool progressive = false; // resource factors instead of a feasibility mask
+
+    DecisionKey() {}
+    DecisionKey(const TaskRequirements& req, bool progressive);
+
+    /** The requirements of the key, with no position requirement. */
+    TaskRequirements requirements() const;
+
+    bool operator==(const DecisionKey& o) const;
+};
+
+struct DecisionKeyHash
+{
+    size_t operator()(const DecisionKey& key) const;
+};
+
+/**
+ * Memoized placement decisions over a NodeTable.
+ *
+ * An entry remembers the table version it was computed at. When the table
+ * has not changed since, the entry is returned as is; otherwise only the
+ * slots reported by NodeTable::changedSince() are re-evaluated.
+ *
+ * Entries hold what does not depend on the task position: the nodes that
+ * meet the resource requirements, or the resource factors of the
+ * progressive scores. See selectInCircle() and
+ * CandidateEvaluator::combineProgressiveScores() for the position part.
+ * The entries evaluate the current load of every slot: the caller must
+ * re-evaluate the slots with a timeline (NodeTable::scheduledSlots()).
+ */
+class INET_API DecisionCache
+{
+  public:
+    struct Entry
+    {
+        uint64_t tableVersion = 0;
+        std::vector<uint64_t> mask;   // resource feasibility per slot (feasibility entries)
+        std::vector<double> scores;   // resource factor per slot (progressive entries)
+        std::vector<int> candidates;  // feasible (progressive: all) slots, sorted by address
+    };
+
+  protected:
+    std::unordered_map<DecisionKey, Entry, DecisionKeyHash> entries;
+    size_t maxEntries = 64;
+    Entry uncached; // used when caching is disabled
+
+    std::vector<int> changed;         // scratch
+    std::vector<uint8_t> wasFeasible; // scratch
+    long numHits = 0;
+    long numUpdates = 0;
+    long numMisses = 0;
+
+    void evaluateAll(const NodeTable& table, const DecisionKey& key, Entry& entry);
+    void evaluateChanged(const NodeTable& table, const DecisionKey& key, Entry& entry);
+
+  public:
+    DecisionCache() {}
+
+    /** Maximum number of signatures kept (0 disables caching). */
+    void setMaxEntries(size_t n) { maxEntries = n; entries.clear(); }
+    void clear() { entries.clear(); }
+
+    /** Returns the decision for the key, computing only what changed in the table since the last call. */
+    const Entry& lookup(const NodeTable& table, const DecisionKey& key);
+
+    /**
+     * The candidates of a feasibility entry within range of (x, y), sorted by
+     * address; only the grid cells overlapping the circle are visited.
+     */
+    void selectInCircle(const NodeTable& table, const Entry& entry, double x, double y, double range, std::vector<int>& out) const;
+
+    long getNumHits() const { return numHits; }
+    long getNumUpdates() const { return numUpdates; }
+    long getNumMisses() const { return numMisses; }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONCACHE_H_ */
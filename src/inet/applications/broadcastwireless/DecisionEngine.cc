@@ -0,0 +1,131 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "DecisionEngine.h"
+
+#include <cmath>
+
+namespace inet {
+
+bool DecisionEngine::isInsideCircle(double xCenter, double yCenter, double radius, double xPoint, double yPoint)
+{
+    double dx = xPoint - xCenter;
+    double dy = yPoint - yCenter;
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+bool DecisionEngine::isDeployFeasible(const TaskRequirements& req, const CandidateNode& node)
+{
+    bool ris = true;
+
+    //check coords
+    if (req.reqPosition && !isInsideCircle(req.posX, req.posY, req.range, node.coordX, node.coordY))
+        ris = false;
+
+    //check GPU
+    if (req.reqGPU && (node.lockedGPU || !node.hasGPU))
+        ris = false;
+
+    //check locked Fly
+    if (req.reqLockFly && node.lockedFly)
+        return false;
+
+    //check camera
+    if (req.reqCamera && (node.lockedCamera || !node.hasCamera))
+        ris = false;
+
+    //check CPU
+    if ((req.reqCPU + node.compActUsage) > node.compMaxUsage)
+        ris = false;
+
+    //check Memory
+    if ((req.reqMemory + node.memoryActUsage) > node.memoryMaxUsage)
+        ris = false;
+
+    return ris;
+}
+
+double DecisionEngine::directionFactor(double xa, double ya, double xb, double yb, double xd, double yd, double alphaDegrees)
+{
+    // vectors AD and AB
+    double ADx = xd - xa;
+    double ADy = yd - ya;
+    double ABx = xb - xa;
+    double ABy = yb - ya;
+
+    double dot = (ADx * ABx) + (ADy * ABy);
+    double magAD = std::sqrt(ADx * ADx + ADy * ADy);
+    double magAB = std::sqrt(ABx * ABx + ABy * ABy);
+
+    // zero-length vectors: the angle is undefined
+    if (magAD < 1e-9 || magAB < 1e-9)
+        return 0.0;
+
+    // clamp against rounding before acos
+    double cosTheta = dot / (magAD * magAB);
+    if (cosTheta > 1.0)
+        cosTheta = 1.0;
+    else if (cosTheta < -1.0)
+        cosTheta = -1.0;
+
+    double thetaDeg = std::acos(cosTheta) * 180.0 / M_PI;
+
+    // f(theta) = 1 - (theta / alpha), clipped to [0, 1]
+    if (thetaDeg <= 0.0)
+        return 1.0;
+    else if (thetaDeg >= alphaDegrees)
+        return 0.0;
+    else
+        return 1.0 - (thetaDeg / alphaDegrees);
+}
+
+double DecisionEngine::progressiveScore(const TaskRequirements& req, const CandidateNode& node,
+        double originX, double originY, double alphaDegrees)
+{
+    double pos_fact = 1;
+    double gpu_fact = 1;
+    double mem_fact = 1;
+    double cpu_fact = 1;
+    double fly_fact = 1;
+    double cam_fact = 1;
+
+    //check coords
+    if (req.reqPosition)
+        pos_fact = directionFactor(originX, originY, node.coordX, node.coordY, req.posX, req.posY, alphaDegrees);
+
+    //check GPU
+    if (req.reqGPU && (node.lockedGPU || !node.hasGPU))
+        gpu_fact = 0;
+
+    //check locked Fly
+    if (req.reqLockFly && node.lockedFly)
+        fly_fact = 0;
+
+    //check camera
+    if (req.reqCamera && (node.lockedCamera || !node.hasCamera))
+        cam_fact = 0;
+
+    //check CPU
+    if ((req.reqCPU + node.compActUsage) > node.compMaxUsage)
+        cpu_fact = node.compMaxUsage / (req.reqCPU + node.compActUsage);
+
+    //check Memory
+    if ((req.reqMemory + node.memoryActUsage) > node.memoryMaxUsage)
+        mem_fact = node.memoryMaxUsage / (req.reqMemory + node.memoryActUsage);
+
+    return (0.5 * pos_fact) + (0.5 * ((gpu_fact + fly_fact + cam_fact + cpu_fact + mem_fact) / 5.0));
+}
+
+} // namespace inet
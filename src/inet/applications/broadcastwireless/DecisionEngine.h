@@ -0,0 +1,157 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONENGINE_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONENGINE_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "CandidateEvaluator.h"
+
+// NOTE: this file must not depend on OMNeT++/INET headers, it is also built by bench/
+
+namespace inet {
+
+/**
+ * Plain copy of the NodeData fields used by the placement checks.
+ */
+struct CandidateNode
+{
+    double coordX = 0;
+    double coordY = 0;
+    double compActUsage = 0;
+    double compMaxUsage = 0;
+    double memoryActUsage = 0;
+    double memoryMaxUsage = 0;
+    bool hasCamera = false;
+    bool lockedCamera = false;
+    bool hasGPU = false;
+    bool lockedGPU = false;
+    bool lockedFly = false;
+};
+
+/**
+ * Module parameters of the placement, read once at initialization.
+ */
+struct PlacementPolicy
+{
+    double gammaAlmostAll = 2;    // FORALL and MANY tasks
+    double gammaAtLeastOne = 1.7; // the other strategies
+    double alphaDegrees = 90;     // half-width of the progressive arc
+};
+
+/**
+ * Placement and table-merge logic of SimpleBroadcast1Hop, without the
+ * simulator: positions, parameters and random draws are passed in by the
+ * caller. CandidateEvaluator is the batch version of the per-node checks.
+ */
+class DecisionEngine
+{
+  public:
+    static bool isInsideCircle(double xCenter, double yCenter, double radius, double xPoint, double yPoint);
+
+    /** True when the node can host the task. */
+    static bool isDeployFeasible(const TaskRequirements& req, const CandidateNode& node);
+
+    /**
+     * 1 when B lies on the A->D direction, decreasing linearly to 0 at
+     * alphaDegrees off it; 0 when A coincides with B or D.
+     */
+    static double directionFactor(double xa, double ya, double xb, double yb, double xd, double yd, double alphaDegrees);
+
+    /** Progressive score of the node, as seen from (originX, originY). */
+    static double progressiveScore(const TaskRequirements& req, const CandidateNode& node,
+            double originX, double originY, double alphaDegrees);
+
+    /** Score normalization of the progressive dissemination. */
+    static double gamma(const PlacementPolicy& policy, bool keepAll) {
+        return keepAll ? policy.gammaAlmostAll : policy.gammaAtLeastOne;
+    }
+
+    /**
+     * Destinations among the feasible nodes: all of them when keepAll
+     * (FORALL and MANY tasks), otherwise the one at index draw(n), n > 0.
+     */
+    template<typename Key, typename Draw>
+    static void selectAmong(const std::vector<Key>& feasible, bool keepAll, Draw&& draw, std::vector<Key>& out);
+
+    /**
+     * Merges a neighbour's node list into the local table. Both are sorted by
+     * key, so the list is walked in lockstep with the table. An entry is taken
+     * when it is newer than the local one and is routed through the sender,
+     * unless the local route is shorter.
+     *
+     * Table: seek(key, cursor), getTimestamp(slot), getNumHops(slot),
+     *        getNextHop(slot), set(slot, data), upsert(key, data).
+     * List:  Data, size(), key(i), timestamp(i), numHops(i), read(i, data);
+     *        read() fills everything but nextHop_address and num_hops.
+     *
+     * Entries of self and loopback are skipped. Returns the number of entries taken.
+     */
+    template<typename Table, typename List, typename Key>
+    static int mergeSortedList(Table& table, const List& list, const Key& sender, const Key& self, const Key& loopback);
+};
+
+template<typename Key, typename Draw>
+void DecisionEngine::selectAmong(const std::vector<Key>& feasible, bool keepAll, Draw&& draw, std::vector<Key>& out)
+{
+    if (feasible.empty())
+        return;
+    if (keepAll)
+        out.insert(out.end(), feasible.begin(), feasible.end());
+    else
+        out.push_back(feasible[draw((int)feasible.size())]);
+}
+
+template<typename Table, typename List, typename Key>
+int DecisionEngine::mergeSortedList(Table& table, const List& list, const Key& sender, const Key& self, const Key& loopback)
+{
+    int changed = 0;
+    size_t cursor = 0;
+    typename List::Data data;
+
+    size_t n = list.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Key& key = list.key(i);
+        if ((key == loopback) || (key == self))
+            continue;
+
+        int slot = table.seek(key, cursor);
+        if ((slot >= 0) && !(table.getTimestamp(slot) < list.timestamp(i)))
+            continue;
+
+        list.read(i, data);
+
+        // route through the sender, unless the old next_hop was better
+        data.nextHop_address = sender;
+        data.num_hops = list.numHops(i) + 1;
+        if ((slot >= 0) && (table.getNumHops(slot) < data.num_hops)) {
+            data.nextHop_address = table.getNextHop(slot);
+            data.num_hops = table.getNumHops(slot);
+        }
+
+        if (slot >= 0)
+            table.set(slot, data);
+        else
+            table.upsert(key, data);
+        changed++;
+    }
+    return changed;
+}
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_DECISIONENGINE_H_ */
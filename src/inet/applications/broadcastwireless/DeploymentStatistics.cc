@@ -0,0 +1,357 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "DeploymentStatistics.h"
+#include "TaskExporter.h"
+
+#include <algorithm>
+
+namespace inet {
+
+Define_Module(DeploymentStatistics);
+
+void DeploymentStatistics::OverlapSums::add(const Overlap& o, int numActual, int sign)
+{
+    if (numActual == 0)
+        return;
+
+    onlyExpectedTotal += sign * o.onlyExpected();
+    onlyActualTotal += sign * o.onlyActual(numActual);
+    bothTotal += sign * o.both;
+
+    if (!o.nodes.empty()) {
+        double sss = o.nodes.size();
+        onlyExpectedRatio += sign * (o.onlyExpected() / sss);
+        onlyActualRatio += sign * (o.onlyActual(numActual) / sss);
+        bothRatio += sign * (o.both / sss);
+        numRatios += sign;
+    }
+}
+
+DeploymentStatistics::~DeploymentStatistics()
+{
+    delete exporter;
+}
+
+void DeploymentStatistics::initialize()
+{
+    startMakingStats = par("startMakingStats");
+    printReport = par("printTaskReport");
+
+    std::string exportFile = par("taskExportFile").stdstringValue();
+    if (!exportFile.empty()) {
+        int blockSize = par("taskExportBlockSize");
+        if (blockSize <= 0)
+            throw cRuntimeError("Invalid taskExportBlockSize %d", blockSize);
+        exporter = new TaskExporter();
+        exporter->open(exportFile, blockSize);
+    }
+
+    taskGeneratedSignal = registerSignal("taskGenerated");
+    taskDeployedSignal = registerSignal("taskDeployed");
+    taskAckedSignal = registerSignal("taskAcked");
+    infoPacketSentSignal = registerSignal("infoPacketSent");
+
+    // the nodes emit the signals, they propagate up to the network
+    cModule *network = getParentModule();
+    network->subscribe(taskGeneratedSignal, this);
+    network->subscribe(taskDeployedSignal, this);
+    network->subscribe(taskAckedSignal, this);
+    network->subscribe(infoPacketSentSignal, this);
+
+    WATCH(numGenerated);
+    WATCH(numDeployments);
+    WATCH(numInfoPackets);
+}
+
+void DeploymentStatistics::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("This module does not process messages");
+}
+
+void DeploymentStatistics::receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details)
+{
+    if (signalID == infoPacketSentSignal) {
+        numInfoPackets++;
+        infoPacketBytes += value;
+    }
+}
+
+void DeploymentStatistics::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    if (signalID == taskGeneratedSignal)
+        taskGenerated(*check_and_cast<TaskGeneratedDetails *>(obj));
+    else if (signalID == taskDeployedSignal)
+        taskDeployed(*check_and_cast<TaskDeployedDetails *>(obj));
+    else if (signalID == taskAckedSignal)
+        taskAcked(*check_and_cast<TaskAckedDetails *>(obj));
+}
+
+DeploymentStatistics::TaskRecord& DeploymentStatistics::getRecord(const TaskKey& key)
+{
+    auto it = recordOf.find(key);
+    if (it != recordOf.end())
+        return records[it->second];
+
+    recordOf[key] = records.size();
+    records.emplace_back();
+    TaskRecord& record = records.back();
+    record.info.gen_address = key.first;
+    record.info.id_task = key.second;
+    return record;
+}
+
+void DeploymentStatistics::taskGenerated(const TaskGeneratedDetails& details)
+{
+    const TaskREQ& task = *details.task;
+    TaskRecord& record = getRecord(std::make_pair(task.getGen_ipAddress(), task.getId()));
+    if (record.generated)
+        throw cRuntimeError("Task %s-%u generated twice", task.getGen_ipAddress().str().c_str(), task.getId());
+
+    record.generated = true;
+    record.info.generation_time = task.getGen_timestamp();
+    record.info.strategy = (Strategy)task.getStrategy();
+    record.deployable.nodes = *details.deployableNodes;
+    std::sort(record.deployable.nodes.begin(), record.deployable.nodes.end());
+    record.decision.nodes = *details.decisionNodes;
+    std::sort(record.decision.nodes.begin(), record.decision.nodes.end());
+
+    numGenerated++;
+    if (!record.deployable.nodes.empty())
+        numGeneratedDeployable++;
+
+    if (exporter != nullptr)
+        exporter->writeTask(record.info, record.deployable.nodes, record.decision.nodes);
+}
+
+void DeploymentStatistics::taskDeployed(const TaskDeployedDetails& details)
+{
+    const TaskREQ& task = *details.task;
+    TaskRecord& record = getRecord(std::make_pair(task.getGen_ipAddress(), task.getId()));
+
+    Task_Deployed_stat_info si;
+    si.add_deploy_node = details.node;
+    si.deploy_time = simTime() - record.info.generation_time;
+    si.node_pos_coord_x = details.coordX;
+    si.node_pos_coord_y = details.coordY;
+    si.num_hops_to_deploy = task.getHops_to_deploy();
+
+    numDeployments++;
+    deployDelaySum += si.deploy_time.dbl();
+
+    if (!record.generated) {
+        record.info.extra_info.push_back(si);
+        return;
+    }
+
+    int numActual = record.info.extra_info.size();
+    deployableSums.add(record.deployable, numActual, -1);
+    decisionSums.add(record.decision, numActual, -1);
+
+    for (Overlap *o : { &record.deployable, &record.decision }) {
+        auto range = std::equal_range(o->nodes.begin(), o->nodes.end(), details.node);
+        o->both += range.second - range.first;
+        if (range.first != range.second)
+            o->actualIn++;
+    }
+    record.info.extra_info.push_back(si);
+    numActual++;
+
+    if (exporter != nullptr)
+        exporter->writeDeployment(record.info, si);
+
+    deployableSums.add(record.deployable, numActual, 1);
+    decisionSums.add(record.decision, numActual, 1);
+
+    numGeneratedDeployments++;
+    generatedDeployDelaySum += si.deploy_time.dbl();
+    generatedDeployHopsSum += si.num_hops_to_deploy;
+    if (numActual == 1)
+        numDeployedAtLeast1++;
+    if (numActual == 2)
+        numDeployedMoreThan1++;
+    if (!record.deployable.nodes.empty()) {
+        numDeployableDeployments++;
+        if (numActual == 1)
+            numDeployableDeployedAtLeast1++;
+    }
+}
+
+void DeploymentStatistics::taskAcked(const TaskAckedDetails& details)
+{
+    const TaskREQ& task = *details.task;
+    getRecord(std::make_pair(task.getGen_ipAddress(), task.getId())).numAcks++;
+    numAcks++;
+}
+
+void DeploymentStatistics::finish()
+{
+    if (exporter != nullptr)
+        exporter->close();
+    if (printReport)
+        printTaskReport();
+
+    recordScalar("expected only deployment total", deployableSums.onlyExpectedTotal);
+    recordScalar("actual only deployment total", deployableSums.onlyActualTotal);
+    recordScalar("expected and actual deployment total", deployableSums.bothTotal);
+
+    long n = deployableSums.numRatios;
+    double expected_size = n > 0 ? deployableSums.onlyExpectedRatio / n : 0;
+    double actual_size = n > 0 ? deployableSums.onlyActualRatio / n : 0;
+    double both_size = n > 0 ? deployableSums.bothRatio / n : 0;
+    recordScalar("expected only deployment size total", expected_size);
+    recordScalar("actual only deployment size total", actual_size);
+    recordScalar("expected and actual deployment size total", both_size);
+
+    // as in the original post-processing, "at least 1" counts the tasks deployed more than once
+    double ratio_task_deployed_at_least_1_total = numGenerated > 0 ? (double)numDeployedMoreThan1 / numGenerated : 1;
+    double ratio_task_deployed_total = numGenerated > 0 ? (double)numDeployments / numGenerated : 1;
+    recordScalar("task generated total", numGenerated);
+    recordScalar("task deployed total", numDeployments);
+    recordScalar("ratio task deployed total", ratio_task_deployed_total);
+    recordScalar("ratio task deployed at_least_1 total", ratio_task_deployed_at_least_1_total);
+    recordScalar("task deployed time avg", numDeployments > 0 ? deployDelaySum / numDeployments : 0);
+    recordScalar("task ACKs received total", numAcks);
+
+    double ok_avg_delay = 0;
+    double ok_avg_num_hops = 0;
+    if (numGeneratedDeployments > 0) {
+        ok_avg_delay = generatedDeployDelaySum / numGeneratedDeployments;
+        ok_avg_num_hops = generatedDeployHopsSum / numGeneratedDeployments;
+    }
+
+    double ok_deployed_deployable_atleast1_ratio = 0;
+    double ok_task_deployed_if_deployable_avg = 0;
+    if (numGeneratedDeployable > 0) {
+        ok_deployed_deployable_atleast1_ratio = (double)numDeployableDeployedAtLeast1 / numGeneratedDeployable;
+        ok_task_deployed_if_deployable_avg = (double)numDeployableDeployments / numGeneratedDeployable;
+    }
+
+    double ok_num_dep_avg = 0;
+    if (numDeployedAtLeast1 > 0)
+        ok_num_dep_avg = (double)numGeneratedDeployments / numDeployedAtLeast1;
+
+    double ok_deploy_over_deployable_avg = 0;
+    if (ok_task_deployed_if_deployable_avg > 0)
+        ok_deploy_over_deployable_avg = ok_num_dep_avg / ok_task_deployed_if_deployable_avg;
+
+    long nd = decisionSums.numRatios;
+    double ok_expectedDecision_size = nd > 0 ? decisionSums.onlyExpectedRatio / nd : 0;
+    double ok_actualDecision_size = nd > 0 ? decisionSums.onlyActualRatio / nd : 0;
+    double ok_bothDecision_size = nd > 0 ? decisionSums.bothRatio / nd : 0;
+
+    simtime_t measured = simTime() - startMakingStats;
+
+    recordScalar("OK - Total Info-layer packets sent", numInfoPackets);
+    recordScalar("OK - Total Info-layer traffic size", infoPacketBytes);
+    recordScalar("OK - Total Info-layer packets sent per second", numInfoPackets / measured.dbl());
+    recordScalar("OK - Total Info-layer traffic size per second", infoPacketBytes / measured.dbl());
+    recordScalar("OK - task deployed time avg", ok_avg_delay);
+    recordScalar("OK - task deployed hops avg", ok_avg_num_hops);
+    recordScalar("OK - task generated number", numGenerated);
+    recordScalar("OK - task deployable generated number", numGeneratedDeployable);
+    recordScalar("OK - task total deployment number", numGeneratedDeployments);
+    recordScalar("OK - task total deployment at least 1 number", numDeployedAtLeast1);
+    recordScalar("OK - task deployable total deployment at least 1 number", numDeployableDeployedAtLeast1);
+    recordScalar("OK - task deployable total deployment at least 1 number - Ratio", ok_deployed_deployable_atleast1_ratio);
+    recordScalar("OK - task deployable total deployment number for each task - AVG", ok_task_deployed_if_deployable_avg);
+    recordScalar("OK - task deployment number for each task - AVG", ok_num_dep_avg);
+    recordScalar("OK - task deployment number over deployable for each task - AVG", ok_deploy_over_deployable_avg);
+
+    recordScalar("OK - expected only deployment size total", expected_size);
+    recordScalar("OK - actual only deployment size total", actual_size);
+    recordScalar("OK - expected and actual deployment size total", both_size);
+
+    recordScalar("OK - expected Decision only deployment size total", ok_expectedDecision_size);
+    recordScalar("OK - actual Decision only deployment size total", ok_actualDecision_size);
+    recordScalar("OK - expected and actual Decision deployment size total", ok_bothDecision_size);
+}
+
+void DeploymentStatistics::printTaskReport() const
+{
+    for (const TaskRecord& record : records) {
+        if (!record.generated)
+            continue;
+        printf("TASK:%s-%d DEPLOYED IN:\n", record.info.gen_address.str().c_str(), record.info.id_task);
+        for (auto& dd : record.info.extra_info)
+            printf("node:%s - ", dd.add_deploy_node.str().c_str());
+        printf("\n");
+    }
+
+    printf("\n\nGOOD STATS\n");
+    for (const TaskRecord& record : records) {
+        if (!record.generated)
+            continue;
+        const Task_Generated_stat_info& act_stat = record.info;
+
+        printf("  TASK:%s-%d, strategy %d. Generated at time %s.\n",
+                act_stat.gen_address.str().c_str(), act_stat.id_task, act_stat.strategy, act_stat.generation_time.str().c_str());
+
+        printf("  Deployable nodes: ");
+        for (auto& dn : record.deployable.nodes)
+            printf("%s ", dn.str().c_str());
+        printf("\n");
+
+        printf("  Decision where to deploy nodes: ");
+        for (auto& dn : record.decision.nodes)
+            printf("%s ", dn.str().c_str());
+        printf("\n");
+
+        printf("  Deployed in:\n");
+        for (auto& dd : act_stat.extra_info)
+            printf("    node:%s; deploy time:%s \n", dd.add_deploy_node.str().c_str(), dd.deploy_time.str().c_str());
+
+        if (!act_stat.extra_info.empty()) {
+            const char *prefixes[] = { "", "Decision " };
+            const Overlap *overlaps[] = { &record.deployable, &record.decision };
+            for (int k = 0; k < 2; k++) {
+                const Overlap& o = *overlaps[k];
+                if (o.nodes.empty())
+                    continue;
+
+                std::vector<L3Address> actual;
+                for (auto& dd : act_stat.extra_info)
+                    actual.push_back(dd.add_deploy_node);
+                std::sort(actual.begin(), actual.end());
+
+                printf("      TASK:%s-%d\n", act_stat.gen_address.str().c_str(), act_stat.id_task);
+                printf("      %sOE:", prefixes[k]);
+                for (auto& el : o.nodes)
+                    if (!std::binary_search(actual.begin(), actual.end(), el))
+                        printf("%s - ", el.str().c_str());
+                printf("\n      %sOA:", prefixes[k]);
+                for (auto& el : act_stat.extra_info)
+                    if (!std::binary_search(o.nodes.begin(), o.nodes.end(), el.add_deploy_node))
+                        printf("%s - ", el.add_deploy_node.str().c_str());
+                printf("\n      %sB:", prefixes[k]);
+                for (auto& el : o.nodes)
+                    if (std::binary_search(actual.begin(), actual.end(), el))
+                        printf("%s - ", el.str().c_str());
+                printf("\n");
+
+                double sss = o.nodes.size();
+                int numActual = act_stat.extra_info.size();
+                printf("      %sonlyExpected: %f \n", prefixes[k], o.onlyExpected() / sss);
+                printf("      %sonlyActual: %f \n", prefixes[k], o.onlyActual(numActual) / sss);
+                printf("      %sboth: %f \n\n", prefixes[k], o.both / sss);
+            }
+        }
+
+        printf("\n");
+    }
+}
+
+} // namespace inet
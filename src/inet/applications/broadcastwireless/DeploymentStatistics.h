@@ -0,0 +1,186 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_DEPLOYMENTSTATISTICS_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_DEPLOYMENTSTATISTICS_H_
+
+#include <vector>
+#include <map>
+
+#include "inet/common/INETDefs.h"
+#include "inet/networklayer/common/L3Address.h"
+
+#include "TaskREQ_m.h"
+
+namespace inet {
+
+class TaskExporter;
+
+struct Task_Deployed_stat_info
+{
+    simtime_t deploy_time;  // since the generation of the task
+    L3Address add_deploy_node;
+    double node_pos_coord_x;
+    double node_pos_coord_y;
+    int num_hops_to_deploy;
+};
+
+struct Task_Generated_stat_info
+{
+    simtime_t generation_time;
+    L3Address gen_address;
+    uint32_t id_task;
+    Strategy strategy;
+    std::vector<Task_Deployed_stat_info> extra_info;
+};
+
+/**
+ * Details of the taskGenerated signal. The node lists are only valid
+ * during the emit.
+ */
+class INET_API TaskGeneratedDetails : public cObject
+{
+  public:
+    const TaskREQ *task = nullptr;
+    const std::vector<L3Address> *deployableNodes = nullptr;
+    const std::vector<L3Address> *decisionNodes = nullptr;
+};
+
+/**
+ * Details of the taskDeployed signal.
+ */
+class INET_API TaskDeployedDetails : public cObject
+{
+  public:
+    const TaskREQ *task = nullptr;
+    L3Address node;
+    double coordX = 0;
+    double coordY = 0;
+};
+
+/**
+ * Details of the taskAcked signal.
+ */
+class INET_API TaskAckedDetails : public cObject
+{
+  public:
+    const TaskREQ *task = nullptr;
+    L3Address node;   // the node that sent the ACK
+};
+
+/**
+ * Collects the task statistics of all the SimpleBroadcast1Hop nodes of the
+ * network from their signals. See NED for more info.
+ *
+ * The overlaps between the deployable, decision and actual node sets are
+ * kept per task and updated at each deployment, together with their sums
+ * over all tasks, so finish() only divides.
+ */
+class INET_API DeploymentStatistics : public cSimpleModule, public cListener
+{
+  public:
+    typedef std::pair<L3Address, uint32_t> TaskKey;
+
+    /** Overlap of the actual deployments with one of the sets known at generation. */
+    struct Overlap
+    {
+        std::vector<L3Address> nodes;  // sorted
+        int both = 0;          // entries of nodes that got the task
+        int actualIn = 0;      // deployments on one of the nodes
+
+        int onlyExpected() const { return nodes.size() - both; }
+        int onlyActual(int numActual) const { return numActual - actualIn; }
+    };
+
+    struct TaskRecord
+    {
+        Task_Generated_stat_info info;
+        bool generated = false;  // the generation was seen, not only deployments
+        Overlap deployable;
+        Overlap decision;
+        int numAcks = 0;
+    };
+
+    /** Sums over the tasks that have been deployed at least once. */
+    struct OverlapSums
+    {
+        double onlyExpectedTotal = 0;
+        double onlyActualTotal = 0;
+        double bothTotal = 0;
+        // ratios to the expected set size, only for tasks with a non-empty one
+        double onlyExpectedRatio = 0;
+        double onlyActualRatio = 0;
+        double bothRatio = 0;
+        long numRatios = 0;
+
+        void add(const Overlap& o, int numActual, int sign);
+    };
+
+  protected:
+    simsignal_t taskGeneratedSignal;
+    simsignal_t taskDeployedSignal;
+    simsignal_t taskAckedSignal;
+    simsignal_t infoPacketSentSignal;
+
+    simtime_t startMakingStats;
+    bool printReport = false;
+    TaskExporter *exporter = nullptr;  // when taskExportFile is set
+
+    std::map<TaskKey, int> recordOf;  // task -> index in records
+    std::vector<TaskRecord> records;  // in generation order
+
+    OverlapSums deployableSums;
+    OverlapSums decisionSums;
+
+    long numGenerated = 0;
+    long numGeneratedDeployable = 0;
+    long numDeployments = 0;            // of any task
+    long numGeneratedDeployments = 0;   // of the generated tasks
+    long numDeployedAtLeast1 = 0;
+    long numDeployedMoreThan1 = 0;
+    long numDeployableDeployedAtLeast1 = 0;
+    long numDeployableDeployments = 0;
+    long numAcks = 0;
+    double deployDelaySum = 0;          // of any task
+    double generatedDeployDelaySum = 0;
+    double generatedDeployHopsSum = 0;
+
+    long numInfoPackets = 0;
+    long infoPacketBytes = 0;
+
+    virtual ~DeploymentStatistics();
+
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    TaskRecord& getRecord(const TaskKey& key);
+    void taskGenerated(const TaskGeneratedDetails& details);
+    void taskDeployed(const TaskDeployedDetails& details);
+    void taskAcked(const TaskAckedDetails& details);
+
+    void printTaskReport() const;
+
+  public:
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+
+    const std::vector<TaskRecord>& getRecords() const { return records; }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_DEPLOYMENTSTATISTICS_H_ */
@@ -0,0 +1,467 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "InputLog.h"
+
+#include "inet/common/INETUtils.h"
+
+#include "Heartbeat_m.h"
+#include "TaskREQ_m.h"
+
+namespace inet {
+
+const uint32_t InputLogWriter::MAGIC;
+const uint32_t InputLogWriter::VERSION;
+
+// payload encoding, field by field in the order of the msg files
+
+static void writeTask(SnapshotWriter& w, const TaskREQ& t)
+{
+    w.writeAddress(t.getGen_ipAddress());
+    w.write<uint32_t>(t.getId());
+    w.writeTime(t.getGen_timestamp());
+    w.write<uint8_t>(t.getHops_to_deploy());
+    w.write<uint8_t>(t.getStrategy());
+    w.write<uint8_t>(t.getDevType());
+    w.writeTime(t.getStart_timestamp());
+    w.writeTime(t.getEnd_timestamp());
+    w.write<uint8_t>(t.getReqPosition());
+    w.write(t.getPos_coord_x());
+    w.write(t.getPos_coord_y());
+    w.write(t.getRange());
+    w.write<uint8_t>(t.getReq_lock_flyengine());
+    w.write<uint8_t>(t.getReqCamera());
+    w.write<uint8_t>(t.getLockCamera());
+    w.write<uint8_t>(t.getReqGPU());
+    w.write<uint8_t>(t.getLockGPU());
+    w.write(t.getReqCPU());
+    w.write(t.getReqMemory());
+}
+
+static TaskREQ readTask(SnapshotReader& r)
+{
+    TaskREQ t;
+    t.setGen_ipAddress(r.readAddress());
+    t.setId(r.read<uint32_t>());
+    t.setGen_timestamp(r.readTime());
+    t.setHops_to_deploy(r.read<uint8_t>());
+    t.setStrategy((Strategy)r.read<uint8_t>());
+    t.setDevType((DevType)r.read<uint8_t>());
+    t.setStart_timestamp(r.readTime());
+    t.setEnd_timestamp(r.readTime());
+    t.setReqPosition(r.read<uint8_t>());
+    t.setPos_coord_x(r.read<double>());
+    t.setPos_coord_y(r.read<double>());
+    t.setRange(r.read<double>());
+    t.setReq_lock_flyengine(r.read<uint8_t>());
+    t.setReqCamera(r.read<uint8_t>());
+    t.setLockCamera(r.read<uint8_t>());
+    t.setReqGPU(r.read<uint8_t>());
+    t.setLockGPU(r.read<uint8_t>());
+    t.setReqCPU(r.read<double>());
+    t.setReqMemory(r.read<double>());
+    return t;
+}
+
+template<typename Msg>
+static void writeTimeline(SnapshotWriter& w, const Msg& msg)
+{
+    w.write<uint32_t>(msg.getCapacityTimelineArraySize());
+    for (size_t i = 0; i < msg.getCapacityTimelineArraySize(); i++) {
+        const CapacityStep& step = msg.getCapacityTimeline(i);
+        w.writeTime(step.getTime());
+        w.write(step.getFreeCPU());
+        w.write(step.getFreeMemory());
+        w.write<uint8_t>(step.getLockedGPU());
+        w.write<uint8_t>(step.getLockedCamera());
+        w.write<uint8_t>(step.getLockedFly());
+    }
+}
+
+template<typename Msg>
+static void readTimeline(SnapshotReader& r, Msg& msg)
+{
+    uint32_t numSteps = r.read<uint32_t>();
+    msg.setCapacityTimelineArraySize(numSteps);
+    for (uint32_t i = 0; i < numSteps; i++) {
+        CapacityStep step;
+        step.setTime(r.readTime());
+        step.setFreeCPU(r.read<double>());
+        step.setFreeMemory(r.read<double>());
+        step.setLockedGPU(r.read<uint8_t>());
+        step.setLockedCamera(r.read<uint8_t>());
+        step.setLockedFly(r.read<uint8_t>());
+        msg.setCapacityTimeline(i, step);
+    }
+}
+
+static void writeHeartbeat(SnapshotWriter& w, const Heartbeat& hb)
+{
+    w.write<uint32_t>(hb.getSequenceNumber());
+    w.writeAddress(hb.getIpAddress());
+    w.write(hb.getCoord_x());
+    w.write(hb.getCoord_y());
+    w.write(hb.getMemoryActUsage());
+    w.write(hb.getMemoryMaxUsage());
+    w.write(hb.getCompActUsage());
+    w.write(hb.getCompMaxUsage());
+    w.write<uint8_t>(hb.getHasCamera());
+    w.write<uint8_t>(hb.getLockedCamera());
+    w.write<uint8_t>(hb.getHasGPU());
+    w.write<uint8_t>(hb.getLockedGPU());
+    w.write<uint8_t>(hb.getLockedFly());
+    w.write(hb.getRadius());
+
+    w.write<uint32_t>(hb.getNodeInfoListArraySize());
+    for (size_t i = 0; i < hb.getNodeInfoListArraySize(); i++) {
+        const NodeInfo& nf = hb.getNodeInfoList(i);
+        w.writeTime(nf.getTimestamp());
+        w.write<uint32_t>(nf.getSequenceNumber());
+        w.writeAddress(nf.getIpAddress());
+        w.write(nf.getCoord_x());
+        w.write(nf.getCoord_y());
+        w.write(nf.getMemoryActUsage());
+        w.write(nf.getMemoryMaxUsage());
+        w.write(nf.getCompActUsage());
+        w.write(nf.getCompMaxUsage());
+        w.write<uint8_t>(nf.getHasCamera());
+        w.write<uint8_t>(nf.getLockedCamera());
+        w.write<uint8_t>(nf.getHasGPU());
+        w.write<uint8_t>(nf.getLockedGPU());
+        w.write<uint8_t>(nf.getLockedFly());
+        w.write(nf.getRadius());
+        w.writeAddress(nf.getNextHop_address());
+        w.write<int32_t>(nf.getNum_hops());
+        writeTimeline(w, nf);
+    }
+    writeTimeline(w, hb);
+}
+
+static Ptr<Heartbeat> readHeartbeat(SnapshotReader& r)
+{
+    const auto& hb = makeShared<Heartbeat>();
+    hb->setSequenceNumber(r.read<uint32_t>());
+    hb->setIpAddress(r.readAddress());
+    hb->setCoord_x(r.read<double>());
+    hb->setCoord_y(r.read<double>());
+    hb->setMemoryActUsage(r.read<double>());
+    hb->setMemoryMaxUsage(r.read<double>());
+    hb->setCompActUsage(r.read<double>());
+    hb->setCompMaxUsage(r.read<double>());
+    hb->setHasCamera(r.read<uint8_t>());
+    hb->setLockedCamera(r.read<uint8_t>());
+    hb->setHasGPU(r.read<uint8_t>());
+    hb->setLockedGPU(r.read<uint8_t>());
+    hb->setLockedFly(r.read<uint8_t>());
+    hb->setRadius(r.read<double>());
+
+    uint32_t numNodes = r.read<uint32_t>();
+    hb->setNodeInfoListArraySize(numNodes);
+    for (uint32_t i = 0; i < numNodes; i++) {
+        NodeInfo nf;
+        nf.setTimestamp(r.readTime());
+        nf.setSequenceNumber(r.read<uint32_t>());
+        nf.setIpAddress(r.readAddress());
+        nf.setCoord_x(r.read<double>());
+        nf.setCoord_y(r.read<double>());
+        nf.setMemoryActUsage(r.read<double>());
+        nf.setMemoryMaxUsage(r.read<double>());
+        nf.setCompActUsage(r.read<double>());
+        nf.setCompMaxUsage(r.read<double>());
+        nf.setHasCamera(r.read<uint8_t>());
+        nf.setLockedCamera(r.read<uint8_t>());
+        nf.setHasGPU(r.read<uint8_t>());
+        nf.setLockedGPU(r.read<uint8_t>());
+        nf.setLockedFly(r.read<uint8_t>());
+        nf.setRadius(r.read<double>());
+        nf.setNextHop_address(r.readAddress());
+        nf.setNum_hops(r.read<int32_t>());
+        readTimeline(r, nf);
+        hb->setNodeInfoList(i, nf);
+    }
+    readTimeline(r, *hb);
+    return hb;
+}
+
+static void writeChangesBlock(SnapshotWriter& w, const ChangesBlock& block)
+{
+    w.writeTime(block.getTimestamp());
+    w.write<uint32_t>(block.getChangesCount());
+    w.write<uint32_t>(block.getChangesListArraySize());
+    for (size_t i = 0; i < block.getChangesListArraySize(); i++) {
+        const Change& ch = block.getChangesList(i);
+        w.write<uint32_t>(ch.getSequenceNumber());
+        w.writeAddress(ch.getIpAddress());
+        w.write<uint8_t>(ch.getParammeter());
+        w.write(ch.getValue());
+        w.write<int32_t>(ch.getHops());
+        w.writeAddress(ch.getNextHop_address());
+    }
+    writeTimeline(w, block);
+}
+
+static Ptr<ChangesBlock> readChangesBlock(SnapshotReader& r)
+{
+    const auto& block = makeShared<ChangesBlock>();
+    block->setTimestamp(r.readTime());
+    block->setChangesCount(r.read<uint32_t>());
+    uint32_t numChanges = r.read<uint32_t>();
+    block->setChangesListArraySize(numChanges);
+    for (uint32_t i = 0; i < numChanges; i++) {
+        Change ch;
+        ch.setSequenceNumber(r.read<uint32_t>());
+        ch.setIpAddress(r.readAddress());
+        ch.setParammeter(r.read<uint8_t>());
+        ch.setValue(r.read<double>());
+        ch.setHops(r.read<int32_t>());
+        ch.setNextHop_address(r.readAddress());
+        block->setChangesList(i, ch);
+    }
+    readTimeline(r, *block);
+    return block;
+}
+
+static void writeTaskREQmessage(SnapshotWriter& w, const TaskREQmessage& msg)
+{
+    w.write<int32_t>(msg.getIdReqMessage());
+    w.write<uint32_t>(msg.getDestDetailArraySize());
+    for (size_t i = 0; i < msg.getDestDetailArraySize(); i++) {
+        const DestDetail& dd = msg.getDestDetail(i);
+        w.write<int32_t>(dd.getTtl());
+        w.writeAddress(dd.getDest_ipAddress());
+        w.writeAddress(dd.getNextHop_ipAddress());
+    }
+    w.write<uint8_t>(msg.getDepStrategy());
+    writeTask(w, msg.getTask());
+}
+
+static Ptr<TaskREQmessage> readTaskREQmessage(SnapshotReader& r)
+{
+    const auto& msg = makeShared<TaskREQmessage>();
+    msg->setIdReqMessage(r.read<int32_t>());
+    uint32_t numDests = r.read<uint32_t>();
+    msg->setDestDetailArraySize(numDests);
+    for (uint32_t i = 0; i < numDests; i++) {
+        DestDetail dd;
+        dd.setTtl(r.read<int32_t>());
+        dd.setDest_ipAddress(r.readAddress());
+        dd.setNextHop_ipAddress(r.readAddress());
+        msg->setDestDetail(i, dd);
+    }
+    msg->setDepStrategy((DeployType)r.read<uint8_t>());
+    msg->setTask(readTask(r));
+    return msg;
+}
+
+static void writeTaskREQ_ACKmessage(SnapshotWriter& w, const TaskREQ_ACKmessage& msg)
+{
+    w.writeAddress(msg.getDest_ipAddress());
+    w.writeAddress(msg.getSrc_ipAddress());
+    writeTask(w, msg.getTask());
+}
+
+static Ptr<TaskREQ_ACKmessage> readTaskREQ_ACKmessage(SnapshotReader& r)
+{
+    const auto& msg = makeShared<TaskREQ_ACKmessage>();
+    msg->setDest_ipAddress(r.readAddress());
+    msg->setSrc_ipAddress(r.readAddress());
+    msg->setTask(readTask(r));
+    return msg;
+}
+
+InputLogWriter::~InputLogWriter()
+{
+    // only left open when the simulation ends with an error: write what is there, without throwing
+    if (f != nullptr) {
+        fwrite(buffer.data(), 1, buffer.size(), f);
+        fclose(f);
+    }
+}
+
+void InputLogWriter::open(const std::string& fileName, const L3Address& address, int index, const Coord& position, size_t blockSize)
+{
+    close();
+    inet::utils::makePathForFile(fileName.c_str());
+    this->fileName = fileName;
+    this->blockSize = blockSize;
+    f = fopen(fileName.c_str(), "wb");
+    if (f == nullptr)
+        throw cRuntimeError("Cannot open input log file '%s'", fileName.c_str());
+    buffer.reserve(blockSize + 4096);
+
+    record.clear();
+    record.write(MAGIC);
+    record.write(VERSION);
+    record.writeAddress(address);
+    record.write<int32_t>(index);
+    record.write(position.x);
+    record.write(position.y);
+    record.write(position.z);
+    buffer.append(record.getData());
+    lastPosition = position;
+    numRecords = 0;
+}
+
+void InputLogWriter::flush()
+{
+    if (fwrite(buffer.data(), 1, buffer.size(), f) != buffer.size())
+        throw cRuntimeError("Error writing input log file '%s'", fileName.c_str());
+    buffer.clear();
+}
+
+void InputLogWriter::close()
+{
+    if (f == nullptr)
+        return;
+    flush();
+    bool ok = fclose(f) == 0;
+    f = nullptr;
+    if (!ok)
+        throw cRuntimeError("Error closing input log file '%s'", fileName.c_str());
+}
+
+void InputLogWriter::beginRecord(InputLogRecordType type, simtime_t time, const Coord& position)
+{
+    record.clear();
+    record.write<uint8_t>(type);
+    record.writeTime(time);
+    record.write(position.x);
+    record.write(position.y);
+    record.write(position.z);
+    lastPosition = position;
+}
+
+void InputLogWriter::endRecord()
+{
+    uint32_t length = record.getData().size();
+    buffer.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    buffer.append(record.getData());
+    numRecords++;
+    if (buffer.size() >= blockSize)
+        flush();
+}
+
+void InputLogWriter::recordPosition(simtime_t time, const Coord& position)
+{
+    if (position == lastPosition)
+        return;
+    beginRecord(INPUT_POSITION, time, position);
+    endRecord();
+}
+
+bool InputLogWriter::recordPayload(simtime_t time, const Coord& position, const L3Address& srcAddr, const L3Address& destAddr, const Chunk& payload)
+{
+    InputLogRecordType type;
+    if (dynamic_cast<const Heartbeat *>(&payload) != nullptr)
+        type = INPUT_HEARTBEAT;
+    else if (dynamic_cast<const ChangesBlock *>(&payload) != nullptr)
+        type = INPUT_CHANGES_BLOCK;
+    else if (dynamic_cast<const TaskREQmessage *>(&payload) != nullptr)
+        type = INPUT_TASK_REQ;
+    else if (dynamic_cast<const TaskREQ_ACKmessage *>(&payload) != nullptr)
+        type = INPUT_TASK_REQ_ACK;
+    else
+        return false;
+
+    beginRecord(type, time, position);
+    record.writeAddress(srcAddr);
+    record.writeAddress(destAddr);
+    record.write<int64_t>(B(payload.getChunkLength()).get());
+    switch (type) {
+        case INPUT_HEARTBEAT: writeHeartbeat(record, static_cast<const Heartbeat&>(payload)); break;
+        case INPUT_CHANGES_BLOCK: writeChangesBlock(record, static_cast<const ChangesBlock&>(payload)); break;
+        case INPUT_TASK_REQ: writeTaskREQmessage(record, static_cast<const TaskREQmessage&>(payload)); break;
+        case INPUT_TASK_REQ_ACK: writeTaskREQ_ACKmessage(record, static_cast<const TaskREQ_ACKmessage&>(payload)); break;
+        default: break;
+    }
+    endRecord();
+    return true;
+}
+
+InputLogReader::~InputLogReader()
+{
+    if (f != nullptr)
+        fclose(f);
+}
+
+void InputLogReader::open(const std::string& fileName)
+{
+    close();
+    this->fileName = fileName;
+    f = fopen(fileName.c_str(), "rb");
+    if (f == nullptr)
+        throw cRuntimeError("Cannot open input log file '%s'", fileName.c_str());
+
+    uint32_t header[2];
+    if (fread(header, sizeof(header), 1, f) != 1 || header[0] != InputLogWriter::MAGIC || header[1] != InputLogWriter::VERSION)
+        throw cRuntimeError("'%s' is not an input log of this version", fileName.c_str());
+    uint32_t length;
+    if (fread(&length, sizeof(length), 1, f) != 1)
+        throw cRuntimeError("Truncated input log '%s'", fileName.c_str());
+    std::string s(length, '\0');
+    if (length > 0 && fread(&s[0], length, 1, f) != 1)
+        throw cRuntimeError("Truncated input log '%s'", fileName.c_str());
+    address = s.empty() ? L3Address() : L3Address(s.c_str());
+    int32_t i;
+    double xyz[3];
+    if (fread(&i, sizeof(i), 1, f) != 1 || fread(xyz, sizeof(xyz), 1, f) != 1)
+        throw cRuntimeError("Truncated input log '%s'", fileName.c_str());
+    index = i;
+    position = Coord(xyz[0], xyz[1], xyz[2]);
+}
+
+void InputLogReader::close()
+{
+    if (f != nullptr)
+        fclose(f);
+    f = nullptr;
+}
+
+bool InputLogReader::next(InputLogRecord& rec)
+{
+    uint32_t length;
+    if (fread(&length, sizeof(length), 1, f) != 1)
+        return false;
+    data.resize(length);
+    if (length > 0 && fread(&data[0], length, 1, f) != 1)
+        throw cRuntimeError("Truncated input log '%s'", fileName.c_str());
+
+    SnapshotReader r(data);
+    rec.type = (InputLogRecordType)r.read<uint8_t>();
+    rec.time = r.readTime();
+    rec.position.x = r.read<double>();
+    rec.position.y = r.read<double>();
+    rec.position.z = r.read<double>();
+    rec.payload = nullptr;
+    if (rec.type != INPUT_POSITION) {
+        rec.srcAddr = r.readAddress();
+        rec.destAddr = r.readAddress();
+        int64_t bytes = r.read<int64_t>();
+        switch (rec.type) {
+            case INPUT_HEARTBEAT: rec.payload = readHeartbeat(r); break;
+            case INPUT_CHANGES_BLOCK: rec.payload = readChangesBlock(r); break;
+            case INPUT_TASK_REQ: rec.payload = readTaskREQmessage(r); break;
+            case INPUT_TASK_REQ_ACK: rec.payload = readTaskREQ_ACKmessage(r); break;
+            default: throw cRuntimeError("Unknown record type %d in input log '%s'", (int)rec.type, fileName.c_str());
+        }
+        rec.payload->setChunkLength(B(bytes));
+    }
+    if (!r.atEnd())
+        throw cRuntimeError("Input log record longer than expected in '%s'", fileName.c_str());
+    return true;
+}
+
+} // namespace inet
@@ -0,0 +1,124 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_INPUTLOG_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_INPUTLOG_H_
+
+#include <cstdio>
+#include <string>
+
+#include "inet/common/INETDefs.h"
+#include "inet/common/geometry/common/Coord.h"
+#include "inet/common/packet/chunk/Chunk.h"
+#include "inet/networklayer/common/L3Address.h"
+
+#include "WarmupSnapshot.h"
+
+namespace inet {
+
+enum InputLogRecordType : uint8_t {
+    INPUT_POSITION,         // the node moved
+    INPUT_HEARTBEAT,        // received payloads
+    INPUT_CHANGES_BLOCK,
+    INPUT_TASK_REQ,
+    INPUT_TASK_REQ_ACK
+};
+
+/**
+ * One application-level input of a node: a received payload, or a move.
+ */
+struct InputLogRecord
+{
+    InputLogRecordType type = INPUT_POSITION;
+    simtime_t time;
+    Coord position;         // of the recording node
+    L3Address srcAddr;      // the rest is only set for received payloads
+    L3Address destAddr;
+    Ptr<Chunk> payload;
+};
+
+/**
+ * Writes the inputs of a SimpleBroadcast1Hop node to a binary file, in
+ * blocks: a header (address, index and initial position of the node), then
+ * length-prefixed records (see SnapshotWriter for the encoding).
+ */
+class INET_API InputLogWriter
+{
+  protected:
+    static const uint32_t MAGIC = 0x494e4c47; // "INLG"
+    static const uint32_t VERSION = 4; // 2: raw simtimes, 3: no capacity timeline, 4: capacity timelines
+    friend class InputLogReader;
+
+    FILE *f = nullptr;
+    std::string fileName;
+    size_t blockSize = 0;
+    std::string buffer;
+    SnapshotWriter record; // scratch
+    Coord lastPosition;
+    long numRecords = 0;
+
+    void beginRecord(InputLogRecordType type, simtime_t time, const Coord& position);
+    void endRecord();
+    void flush();
+
+  public:
+    InputLogWriter() {}
+    ~InputLogWriter();
+
+    void open(const std::string& fileName, const L3Address& address, int index, const Coord& position, size_t blockSize);
+    void close();
+    bool isOpen() const { return f != nullptr; }
+    long getNumRecords() const { return numRecords; }
+
+    /** Records the position if the node moved since the last record. */
+    void recordPosition(simtime_t time, const Coord& position);
+    /** Records a received payload; returns false (recording nothing) for unknown payload types. */
+    bool recordPayload(simtime_t time, const Coord& position, const L3Address& srcAddr, const L3Address& destAddr, const Chunk& payload);
+};
+
+/**
+ * Reads back a file of InputLogWriter, one record at a time.
+ */
+class INET_API InputLogReader
+{
+  protected:
+    FILE *f = nullptr;
+    std::string fileName;
+    std::string data; // of the current record
+    L3Address address;
+    int index = -1;
+    Coord position;
+
+  public:
+    InputLogReader() {}
+    ~InputLogReader();
+
+    void open(const std::string& fileName);
+    void close();
+    bool isOpen() const { return f != nullptr; }
+
+    // header of the file
+    const L3Address& getAddress() const { return address; }
+    int getIndex() const { return index; }
+    const Coord& getPosition() const { return position; }
+
+    /** Reads the next record; returns false at the end of the file. */
+    bool next(InputLogRecord& rec);
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_INPUTLOG_H_ */
@@ -0,0 +1,113 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "NeighbourAggregates.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inet {
+
+static double distance(double x1, double y1, double x2, double y2)
+{
+    return sqrt((x1-x2)*(x1-x2) + (y1-y2)*(y1-y2));
+}
+
+void NeighbourAggregates::add(const Contribution& c)
+{
+    compMaxUsages.insert(c.compMaxUsage);
+    memoryMaxUsages.insert(c.memoryMaxUsage);
+    compActUsages.insert(c.compActUsage);
+    memoryActUsages.insert(c.memoryActUsage);
+    numCamera += c.hasCamera;
+    numFreeCamera += c.freeCamera;
+    numGPU += c.hasGPU;
+    numFreeGPU += c.freeGPU;
+    numFreeFly += c.freeFly;
+    numNodes++;
+}
+
+void NeighbourAggregates::withdraw(const Contribution& c)
+{
+    compMaxUsages.erase(c.compMaxUsage);
+    memoryMaxUsages.erase(c.memoryMaxUsage);
+    compActUsages.erase(c.compActUsage);
+    memoryActUsages.erase(c.memoryActUsage);
+    numCamera -= c.hasCamera;
+    numFreeCamera -= c.freeCamera;
+    numGPU -= c.hasGPU;
+    numFreeGPU -= c.freeGPU;
+    numFreeFly -= c.freeFly;
+    numNodes--;
+}
+
+void NeighbourAggregates::nodeChanged(const NodeTable& table, int slot)
+{
+    if (slot >= (int)contributions.size())
+        contributions.resize(slot + 1);
+
+    Contribution& c = contributions[slot];
+    if (c.present) {
+        withdraw(c);
+        // the farthest node may have moved closer
+        if (radiusValid && distance(radiusX, radiusY, c.x, c.y) >= radius)
+            radiusValid = false;
+    }
+
+    c.present = true;
+    c.x = table.coordX()[slot];
+    c.y = table.coordY()[slot];
+    if (radiusValid)
+        radius = std::max(radius, distance(radiusX, radiusY, c.x, c.y));
+    c.compMaxUsage = table.compMaxUsage()[slot];
+    c.memoryMaxUsage = table.memoryMaxUsage()[slot];
+    c.compActUsage = table.compActUsage()[slot];
+    c.memoryActUsage = table.memoryActUsage()[slot];
+    c.hasCamera = table.hasCamera()[slot];
+    c.freeCamera = table.hasCamera()[slot] && !table.lockedCamera()[slot];
+    c.hasGPU = table.hasGPU()[slot];
+    c.freeGPU = table.hasGPU()[slot] && !table.lockedGPU()[slot];
+    c.freeFly = !table.lockedFly()[slot];
+    add(c);
+}
+
+void NeighbourAggregates::tableCleared(const NodeTable& table)
+{
+    contributions.clear();
+    numNodes = 0;
+    radiusValid = false;
+    compMaxUsages.clear();
+    memoryMaxUsages.clear();
+    compActUsages.clear();
+    memoryActUsages.clear();
+    numCamera = numFreeCamera = numGPU = numFreeGPU = numFreeFly = 0;
+}
+
+double NeighbourAggregates::getRadius(double x, double y) const
+{
+    if (!radiusValid || x != radiusX || y != radiusY) {
+        double r2 = 0;
+        for (const Contribution& c : contributions)
+            if (c.present)
+                r2 = std::max(r2, (x-c.x)*(x-c.x) + (y-c.y)*(y-c.y));
+        radiusValid = true;
+        radiusX = x;
+        radiusY = y;
+        radius = sqrt(r2);
+    }
+    return radius;
+}
+
+} // namespace inet
@@ -0,0 +1,127 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_NEIGHBOURAGGREGATES_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_NEIGHBOURAGGREGATES_H_
+
+#include <map>
+#include <vector>
+
+#include "NodeTable.h"
+
+namespace inet {
+
+/**
+ * Best-of-neighbours metrics advertised by PROGRESSIVE heartbeats, kept up
+ * to date as the node table changes instead of being recomputed on every
+ * send. Minima and maxima are kept in counted multisets, so both inserts
+ * and withdrawals of a contribution cost O(log n). The radius depends on
+ * the position of the reader, so it is computed on read from the raw
+ * positions, and cached until the origin or the farthest node moves.
+ *
+ * The fold over the table is order independent:
+ *  - max CPU/memory capacity, min CPU/memory usage;
+ *  - a resource (camera, GPU) is present if any node has it, and locked
+ *    only if no node has it unlocked;
+ *  - the fly engine is locked only if it is locked on every node.
+ */
+class INET_API NeighbourAggregates : public INodeTableListener
+{
+  protected:
+    /** Multiset of values stored as value -> multiplicity. */
+    class CountedSet
+    {
+      protected:
+        std::map<double, int> counts;
+
+      public:
+        void insert(double v) { counts[v]++; }
+        void erase(double v) {
+            auto it = counts.find(v);
+            if (--it->second == 0)
+                counts.erase(it);
+        }
+        void clear() { counts.clear(); }
+        bool empty() const { return counts.empty(); }
+        double min() const { return counts.begin()->first; }
+        double max() const { return counts.rbegin()->first; }
+    };
+
+    /** What a slot currently contributes to the aggregates. */
+    struct Contribution
+    {
+        bool present = false;
+        double x = 0;
+        double y = 0;
+        double compMaxUsage = 0;
+        double memoryMaxUsage = 0;
+        double compActUsage = 0;
+        double memoryActUsage = 0;
+        bool hasCamera = false;
+        bool freeCamera = false;
+        bool hasGPU = false;
+        bool freeGPU = false;
+        bool freeFly = false;
+    };
+
+    std::vector<Contribution> contributions; // indexed by slot
+    int numNodes = 0;
+
+    // radius cache
+    mutable bool radiusValid = false;
+    mutable double radiusX = 0;
+    mutable double radiusY = 0;
+    mutable double radius = 0;
+
+    CountedSet compMaxUsages;
+    CountedSet memoryMaxUsages;
+    CountedSet compActUsages;
+    CountedSet memoryActUsages;
+    int numCamera = 0;
+    int numFreeCamera = 0;
+    int numGPU = 0;
+    int numFreeGPU = 0;
+    int numFreeFly = 0;
+
+    void add(const Contribution& c);
+    void withdraw(const Contribution& c);
+
+  public:
+    NeighbourAggregates() {}
+
+    virtual void nodeChanged(const NodeTable& table, int slot) override;
+    virtual void tableCleared(const NodeTable& table) override;
+
+    int size() const { return numNodes; }
+    bool empty() const { return numNodes == 0; }
+
+    /** Largest distance from (x, y) to a node, 0 with no nodes. */
+    double getRadius(double x, double y) const;
+
+    // the following are only meaningful when !empty()
+    double getMaxCompMaxUsage() const { return compMaxUsages.max(); }
+    double getMaxMemoryMaxUsage() const { return memoryMaxUsages.max(); }
+    double getMinCompActUsage() const { return compActUsages.min(); }
+    double getMinMemoryActUsage() const { return memoryActUsages.min(); }
+    bool anyCamera() const { return numCamera > 0; }
+    bool anyFreeCamera() const { return numFreeCamera > 0; }
+    bool anyGPU() const { return numGPU > 0; }
+    bool anyFreeGPU() const { return numFreeGPU > 0; }
+    bool anyFreeFly() const { return numFreeFly > 0; }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_NEIGHBOURAGGREGATES_H_ */
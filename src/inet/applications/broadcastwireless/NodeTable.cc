@@ -0,0 +1,373 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "NodeTable.h"
+
+#include <algorithm>
+
+namespace inet {
+
+void NodeTable::clear()
+{
+    slotOf.clear();
+    orderedSlots.clear();
+
+    addresses.clear();
+    timestamps.clear();
+    sequenceNumbers.clear();
+    coordsX.clear();
+    coordsY.clear();
+    memoryActUsages.clear();
+    memoryMaxUsages.clear();
+    compActUsages.clear();
+    compMaxUsages.clear();
+    hasCameras.clear();
+    lockedCameras.clear();
+    hasGPUs.clear();
+    lockedGPUs.clear();
+    lockedFlys.clear();
+    radiuses.clear();
+    lastSeqNumbers.clear();
+    nextHops.clear();
+    numHops.clear();
+    timelines.clear();
+    scheduled.clear();
+    scheduledPos.clear();
+
+    grid.clear();
+
+    // versions keep counting, so nothing computed before the clear looks current
+    versions.clear();
+    journal.clear();
+    journalStart = ++tableVersion;
+
+    for (auto listener : listeners)
+        listener->tableCleared(*this);
+}
+
+void NodeTable::reserve(int n)
+{
+    slotOf.reserve(n);
+    orderedSlots.reserve(n);
+
+    addresses.reserve(n);
+    timestamps.reserve(n);
+    sequenceNumbers.reserve(n);
+    coordsX.reserve(n);
+    coordsY.reserve(n);
+    memoryActUsages.reserve(n);
+    memoryMaxUsages.reserve(n);
+    compActUsages.reserve(n);
+    compMaxUsages.reserve(n);
+    hasCameras.reserve(n);
+    lockedCameras.reserve(n);
+    hasGPUs.reserve(n);
+    lockedGPUs.reserve(n);
+    lockedFlys.reserve(n);
+    radiuses.reserve(n);
+    lastSeqNumbers.reserve(n);
+    nextHops.reserve(n);
+    numHops.reserve(n);
+    timelines.reserve(n);
+    scheduledPos.reserve(n);
+    versions.reserve(n);
+}
+
+void NodeTable::touch(int slot)
+{
+    versions[slot] = ++tableVersion;
+    journal.push_back(slot);
+
+    // keep the journal proportional to the table: drop the older half
+    if (journal.size() > std::max<size_t>(64, 4 * addresses.size())) {
+        size_t drop = journal.size() / 2;
+        journal.erase(journal.begin(), journal.begin() + drop);
+        journalStart += drop;
+    }
+
+    for (auto listener : listeners)
+        listener->nodeChanged(*this, slot);
+}
+
+void NodeTable::removeListener(INodeTableListener *listener)
+{
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+bool NodeTable::changedSince(uint64_t version, std::vector<int>& out) const
+{
+    if (version < journalStart)
+        return false;
+
+    for (uint64_t v = version + 1; v <= tableVersion; ++v) {
+        int slot = journal[v - journalStart - 1];
+        // only the last change of each slot is reported
+        if (versions[slot] == v)
+            out.push_back(slot);
+    }
+    return true;
+}
+
+void NodeTable::setGridCellSize(double cellSize)
+{
+    grid.setCellSize(cellSize);
+    for (int slot = 0; slot < size(); ++slot)
+        grid.update(slot, coordsX[slot], coordsY[slot]);
+}
+
+void NodeTable::queryCircle(double x, double y, double r, std::vector<int>& out) const
+{
+    if (grid.isEnabled()) {
+        grid.queryCircle(x, y, r, out);
+    }
+    else {
+        for (int slot = 0; slot < size(); ++slot)
+            out.push_back(slot);
+    }
+}
+
+int NodeTable::seek(const L3Address& addr, size_t& cursor) const
+{
+    if (cursor > 0 && !(addresses[orderedSlots[cursor - 1]] < addr))
+        return find(addr);
+
+    while (cursor < orderedSlots.size() && addresses[orderedSlots[cursor]] < addr)
+        ++cursor;
+    if (cursor < orderedSlots.size() && addresses[orderedSlots[cursor]] == addr)
+        return orderedSlots[cursor++];
+    return -1;
+}
+
+int NodeTable::upsert(const L3Address& addr)
+{
+    auto it = slotOf.find(addr);
+    if (it != slotOf.end())
+        return it->second;
+
+    int slot = addresses.size();
+    slotOf[addr] = slot;
+
+    addresses.push_back(addr);
+    timestamps.push_back(SIMTIME_ZERO);
+    sequenceNumbers.push_back(0);
+    coordsX.push_back(0);
+    coordsY.push_back(0);
+    memoryActUsages.push_back(0);
+    memoryMaxUsages.push_back(0);
+    compActUsages.push_back(0);
+    compMaxUsages.push_back(0);
+    hasCameras.push_back(false);
+    lockedCameras.push_back(false);
+    hasGPUs.push_back(false);
+    lockedGPUs.push_back(false);
+    lockedFlys.push_back(false);
+    radiuses.push_back(0);
+    lastSeqNumbers.push_back(std::array<uint32_t, 16>());
+    lastSeqNumbers.back().fill(0);
+    nextHops.push_back(L3Address());
+    numHops.push_back(0);
+    timelines.push_back(std::vector<LoadStep>());
+    scheduledPos.push_back(-1);
+    versions.push_back(0);
+
+    grid.update(slot, 0, 0);
+
+    // new nodes are rare compared to updates, so a sorted insert is fine here
+    auto pos = std::lower_bound(orderedSlots.begin(), orderedSlots.end(), addr,
+            [this](int s, const L3Address& a) { return addresses[s] < a; });
+    orderedSlots.insert(pos, slot);
+
+    touch(slot);
+    return slot;
+}
+
+int NodeTable::upsert(const L3Address& addr, const NodeData& data)
+{
+    int slot = upsert(addr);
+    set(slot, data);
+    return slot;
+}
+
+NodeData NodeTable::get(int slot) const
+{
+    NodeData data;
+    data.timestamp = timestamps[slot];
+    data.sequenceNumber = sequenceNumbers[slot];
+    data.address = addresses[slot];
+    data.coord_x = coordsX[slot];
+    data.coord_y = coordsY[slot];
+    data.memoryActUsage = memoryActUsages[slot];
+    data.memoryMaxUsage = memoryMaxUsages[slot];
+    data.compActUsage = compActUsages[slot];
+    data.compMaxUsage = compMaxUsages[slot];
+    data.hasCamera = hasCameras[slot];
+    data.lockedCamera = lockedCameras[slot];
+    data.hasGPU = hasGPUs[slot];
+    data.lockedGPU = lockedGPUs[slot];
+    data.lockedFly = lockedFlys[slot];
+    data.radius = radiuses[slot];
+    std::copy(lastSeqNumbers[slot].begin(), lastSeqNumbers[slot].end(), data.lastSeqNumber);
+    data.nextHop_address = nextHops[slot];
+    data.num_hops = numHops[slot];
+    data.timeline = timelines[slot];
+    return data;
+}
+
+void NodeTable::set(int slot, const NodeData& data)
+{
+    bool changed = coordsX[slot] != data.coord_x || coordsY[slot] != data.coord_y
+            || memoryActUsages[slot] != data.memoryActUsage || memoryMaxUsages[slot] != data.memoryMaxUsage
+            || compActUsages[slot] != data.compActUsage || compMaxUsages[slot] != data.compMaxUsage
+            || hasCameras[slot] != data.hasCamera || lockedCameras[slot] != data.lockedCamera
+            || hasGPUs[slot] != data.hasGPU || lockedGPUs[slot] != data.lockedGPU
+            || lockedFlys[slot] != data.lockedFly;
+
+    // the key column is not touched: the slot keeps the address it was allocated for
+    timestamps[slot] = data.timestamp;
+    sequenceNumbers[slot] = data.sequenceNumber;
+    coordsX[slot] = data.coord_x;
+    coordsY[slot] = data.coord_y;
+    memoryActUsages[slot] = data.memoryActUsage;
+    memoryMaxUsages[slot] = data.memoryMaxUsage;
+    compActUsages[slot] = data.compActUsage;
+    compMaxUsages[slot] = data.compMaxUsage;
+    hasCameras[slot] = data.hasCamera;
+    lockedCameras[slot] = data.lockedCamera;
+    hasGPUs[slot] = data.hasGPU;
+    lockedGPUs[slot] = data.lockedGPU;
+    lockedFlys[slot] = data.lockedFly;
+    radiuses[slot] = data.radius;
+    std::copy(data.lastSeqNumber, data.lastSeqNumber + 16, lastSeqNumbers[slot].begin());
+    nextHops[slot] = data.nextHop_address;
+    numHops[slot] = data.num_hops;
+    setTimeline(slot, data.timeline);
+
+    grid.update(slot, data.coord_x, data.coord_y);
+    if (changed)
+        touch(slot);
+}
+
+void NodeTable::setPosition(int slot, double x, double y)
+{
+    if (coordsX[slot] == x && coordsY[slot] == y)
+        return;
+    coordsX[slot] = x;
+    coordsY[slot] = y;
+    grid.update(slot, x, y);
+    touch(slot);
+}
+
+void NodeTable::setTimeline(int slot, const std::vector<LoadStep>& steps)
+{
+    timelines[slot] = steps;
+
+    int pos = scheduledPos[slot];
+    if (!steps.empty() && pos < 0) {
+        scheduledPos[slot] = scheduled.size();
+        scheduled.push_back(slot);
+    }
+    else if (steps.empty() && pos >= 0) {
+        scheduled[pos] = scheduled.back();
+        scheduledPos[scheduled[pos]] = pos;
+        scheduled.pop_back();
+        scheduledPos[slot] = -1;
+    }
+}
+
+void NodeTable::applyPeakLoad(int slot, simtime_t start, simtime_t end, NodeData& data) const
+{
+    LoadStep load;
+    load.compActUsage = compActUsages[slot];
+    load.memoryActUsage = memoryActUsages[slot];
+    load.lockedGPU = lockedGPUs[slot];
+    load.lockedCamera = lockedCameras[slot];
+    load.lockedFly = lockedFlys[slot];
+
+    // the load at start, then every step before end
+    const std::vector<LoadStep>& steps = timelines[slot];
+    size_t i = 0;
+    while (i < steps.size() && steps[i].time <= start)
+        load = steps[i++];
+    LoadStep peak = load;
+    for (; i < steps.size() && steps[i].time < end; ++i) {
+        peak.compActUsage = std::max(peak.compActUsage, steps[i].compActUsage);
+        peak.memoryActUsage = std::max(peak.memoryActUsage, steps[i].memoryActUsage);
+        peak.lockedGPU |= steps[i].lockedGPU;
+        peak.lockedCamera |= steps[i].lockedCamera;
+        peak.lockedFly |= steps[i].lockedFly;
+    }
+
+    data.compActUsage = peak.compActUsage;
+    data.memoryActUsage = peak.memoryActUsage;
+    data.lockedGPU = peak.lockedGPU;
+    data.lockedCamera = peak.lockedCamera;
+    data.lockedFly = peak.lockedFly;
+}
+
+CandidateColumns NodeTable::columns() const
+{
+    CandidateColumns cols;
+    cols.count = size();
+    cols.coordX = coordsX.data();
+    cols.coordY = coordsY.data();
+    cols.compActUsage = compActUsages.data();
+    cols.compMaxUsage = compMaxUsages.data();
+    cols.memoryActUsage = memoryActUsages.data();
+    cols.memoryMaxUsage = memoryMaxUsages.data();
+    cols.hasCamera = hasCameras.data();
+    cols.lockedCamera = lockedCameras.data();
+    cols.hasGPU = hasGPUs.data();
+    cols.lockedGPU = lockedGPUs.data();
+    cols.lockedFly = lockedFlys.data();
+    return cols;
+}
+
+// Correctly overload operator<< as a non-member function
+std::ostream& operator<<(std::ostream& os, const NodeData& data)
+{
+    os << "{ sequenceNumber: " << data.sequenceNumber
+            << ", address: " << data.address
+            << ", timestamp: " << data.timestamp
+            << ", coord_x: " << data.coord_x
+            << ", coord_y: " << data.coord_y
+            << ", memoryActUsage: " << data.memoryActUsage
+            << ", memoryMaxUsage: " << data.memoryMaxUsage
+            << ", compActUsage: " << data.compActUsage
+            << ", compMaxUsage: " << data.compMaxUsage
+            << ", hasGPU: " << data.hasGPU
+            << ", lockedGPU: " << data.lockedGPU
+            << ", hasCamera: " << data.hasCamera
+            << ", lockedCamera: " << data.lockedCamera
+            << ", lockedFly: " << data.lockedFly
+            << " ||| nextHop_address: " << data.nextHop_address
+            << ", num_hops: " << data.num_hops
+            << ", radius: " << data.radius
+            << ", timeline: " << data.timeline.size() << " steps"
+            << ", lastSeqNumber: ";
+            for (int i=0; i<16; i++) os << data.lastSeqNumber[i] << ","; //for Changes approach
+            os << " }";
+
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const NodeTable& table)
+{
+    os << table.size() << " nodes";
+    for (int slot : table.slotsByAddress())
+        os << "\n" << table.getAddress(slot) << " | " << table.get(slot);
+    return os;
+}
+
+} // namespace inet
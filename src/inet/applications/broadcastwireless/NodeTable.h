@@ -0,0 +1,282 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_NODETABLE_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_NODETABLE_H_
+
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <functional>
+
+#include "inet/networklayer/common/L3Address.h"
+
+#include "CandidateEvaluator.h"
+#include "DecisionEngine.h"
+#include "SpatialGrid.h"
+
+namespace inet {
+
+/**
+ * Usage of a node from a time on, until the next step: the reservations it
+ * advertises in its heartbeats (CapacityStep), as usage instead of free capacity.
+ */
+struct LoadStep
+{
+    simtime_t time;
+    double compActUsage = 0;
+    double memoryActUsage = 0;
+    bool lockedGPU = false;
+    bool lockedCamera = false;
+    bool lockedFly = false;
+};
+
+struct NodeData
+{
+    simtime_t timestamp;
+    int sequenceNumber;
+    L3Address address;
+    double coord_x;
+    double coord_y;
+    double memoryActUsage;
+    double memoryMaxUsage;
+    double compActUsage;
+    double compMaxUsage;
+
+    bool hasCamera;
+    bool lockedCamera;
+
+    bool hasGPU;
+    bool lockedGPU;
+
+    bool lockedFly;
+
+    double radius; //for partial net info
+    uint32_t lastSeqNumber[16]; //last received sequence number for each field - Changes Approach
+
+    L3Address nextHop_address;
+    int num_hops;
+
+    std::vector<LoadStep> timeline; // upcoming changes of the usage fields above, by time
+
+    // Add other fields as needed
+};
+
+/** The fields of a NodeData read by DecisionEngine. */
+inline CandidateNode toCandidateNode(const NodeData& node)
+{
+    CandidateNode c;
+    c.coordX = node.coord_x;
+    c.coordY = node.coord_y;
+    c.compActUsage = node.compActUsage;
+    c.compMaxUsage = node.compMaxUsage;
+    c.memoryActUsage = node.memoryActUsage;
+    c.memoryMaxUsage = node.memoryMaxUsage;
+    c.hasCamera = node.hasCamera;
+    c.lockedCamera = node.lockedCamera;
+    c.hasGPU = node.hasGPU;
+    c.lockedGPU = node.lockedGPU;
+    c.lockedFly = node.lockedFly;
+    return c;
+}
+
+/**
+ * Hash functor for L3Address, so addresses can key unordered containers.
+ */
+struct L3AddressHash
+{
+    size_t operator()(const L3Address& addr) const {
+        if (addr.getType() == L3Address::IPv4)
+            return std::hash<uint32_t>()(addr.toIpv4().getInt());
+        return std::hash<std::string>()(addr.str());
+    }
+};
+
+class NodeTable;
+
+/**
+ * Interface for objects that maintain state derived from a NodeTable.
+ */
+class INET_API INodeTableListener
+{
+  public:
+    virtual ~INodeTableListener() {}
+
+    /** Called after a placement-relevant change of the slot, including its allocation. */
+    virtual void nodeChanged(const NodeTable& table, int slot) = 0;
+    /** Called after the table has been emptied. */
+    virtual void tableCleared(const NodeTable& table) = 0;
+};
+
+/**
+ * Node table of SimpleBroadcast1Hop.
+ *
+ * Every known node gets a dense integer slot; the address->slot map is only
+ * consulted at ingest. The NodeData fields are stored as parallel arrays
+ * (one column per field), so the per-heartbeat and per-decision passes run
+ * over contiguous memory. Slots are never reused: a slot stays valid for the
+ * lifetime of the table (or until clear()).
+ *
+ * Every change to a field read by the placement (position, usage, camera,
+ * GPU and fly flags) bumps the table version and stamps the slot with it,
+ * and is appended to a short journal so caches can catch up incrementally.
+ *
+ * The timeline of a node does not count as such a change: it only matters
+ * for tasks that start later, so the slots that have one are listed apart
+ * (scheduledSlots()) and their peak load over the task lifetime is applied
+ * by the caller (applyPeakLoad()).
+ */
+class INET_API NodeTable
+{
+  protected:
+    std::unordered_map<L3Address, int, L3AddressHash> slotOf;
+    std::vector<int> orderedSlots; // slots sorted by address, for deterministic iteration
+
+    // columns
+    std::vector<L3Address> addresses;
+    std::vector<simtime_t> timestamps;
+    std::vector<int> sequenceNumbers;
+    std::vector<double> coordsX;
+    std::vector<double> coordsY;
+    std::vector<double> memoryActUsages;
+    std::vector<double> memoryMaxUsages;
+    std::vector<double> compActUsages;
+    std::vector<double> compMaxUsages;
+    std::vector<uint8_t> hasCameras;
+    std::vector<uint8_t> lockedCameras;
+    std::vector<uint8_t> hasGPUs;
+    std::vector<uint8_t> lockedGPUs;
+    std::vector<uint8_t> lockedFlys;
+    std::vector<double> radiuses;
+    std::vector<std::array<uint32_t, 16>> lastSeqNumbers;
+    std::vector<L3Address> nextHops;
+    std::vector<int> numHops;
+    std::vector<std::vector<LoadStep>> timelines;
+
+    std::vector<int> scheduled;     // slots with a non-empty timeline
+    std::vector<int> scheduledPos;  // per slot, index in scheduled or -1
+
+    SpatialGrid grid; // over coordsX/coordsY, kept up to date by every write
+
+    uint64_t tableVersion = 0;
+    std::vector<uint64_t> versions; // per slot, table version of its last placement-relevant change
+    std::vector<int> journal;       // journal[i]: slot changed at version journalStart + i + 1
+    uint64_t journalStart = 0;
+
+    std::vector<INodeTableListener *> listeners;
+
+    void touch(int slot);
+
+  public:
+    NodeTable() {}
+
+    int size() const { return addresses.size(); }
+    bool empty() const { return addresses.empty(); }
+    void clear();
+    void reserve(int n);
+
+    void addListener(INodeTableListener *listener) { listeners.push_back(listener); }
+    void removeListener(INodeTableListener *listener);
+
+    /** Enables the spatial index with the given cell size (0 disables it). */
+    void setGridCellSize(double cellSize);
+    /**
+     * Appends to out the slots that may lie inside the circle (all slots when
+     * the grid is disabled); callers still do the exact distance test.
+     */
+    void queryCircle(double x, double y, double r, std::vector<int>& out) const;
+    bool hasGrid() const { return grid.isEnabled(); }
+
+    /** Returns the slot of the given address, or -1 if unknown. */
+    int find(const L3Address& addr) const {
+        auto it = slotOf.find(addr);
+        return it == slotOf.end() ? -1 : it->second;
+    }
+    /**
+     * Same as find(), for a sequence of lookups in increasing address order
+     * starting with cursor = 0: walks the sorted slots instead of hashing.
+     * Out-of-order addresses fall back to find(). Entries allocated between
+     * lookups are handled, as they are inserted at the cursor.
+     */
+    int seek(const L3Address& addr, size_t& cursor) const;
+    bool contains(const L3Address& addr) const { return slotOf.count(addr) != 0; }
+
+    /** Returns the slot of the given address, allocating a zeroed entry if unknown. */
+    int upsert(const L3Address& addr);
+    /** Stores the whole entry for the given address and returns its slot. */
+    int upsert(const L3Address& addr, const NodeData& data);
+
+    /** Slots sorted by address (the iteration order of the former std::map). */
+    const std::vector<int>& slotsByAddress() const { return orderedSlots; }
+
+    NodeData get(int slot) const;
+    void set(int slot, const NodeData& data);
+    /** Moves the node, leaving the other fields as they are. */
+    void setPosition(int slot, double x, double y);
+    /** Replaces the timeline of the node, leaving the other fields as they are. */
+    void setTimeline(int slot, const std::vector<LoadStep>& steps);
+
+    /** Slots with a non-empty timeline, in no particular order. */
+    const std::vector<int>& scheduledSlots() const { return scheduled; }
+    bool isScheduled(int slot) const { return scheduledPos[slot] >= 0; }
+    /**
+     * Writes into data the highest usage and the locks of the node over
+     * [start, end): the usage columns hold the load until the first step of
+     * the timeline, each step the load until the next one.
+     */
+    void applyPeakLoad(int slot, simtime_t start, simtime_t end, NodeData& data) const;
+
+    /** Version of the whole table, bumped by every placement-relevant change. */
+    uint64_t getVersion() const { return tableVersion; }
+    uint64_t getVersion(int slot) const { return versions[slot]; }
+    /**
+     * Appends to out (once each) the slots changed after the given table version.
+     * Returns false if the journal does not reach back that far; callers must
+     * then treat every slot as changed.
+     */
+    bool changedSince(uint64_t version, std::vector<int>& out) const;
+
+    // column access
+    const L3Address& getAddress(int slot) const { return addresses[slot]; }
+    simtime_t getTimestamp(int slot) const { return timestamps[slot]; }
+    int getSequenceNumber(int slot) const { return sequenceNumbers[slot]; }
+    const L3Address& getNextHop(int slot) const { return nextHops[slot]; }
+    int getNumHops(int slot) const { return numHops[slot]; }
+    void setRoute(int slot, const L3Address& nextHop, int hops) { nextHops[slot] = nextHop; numHops[slot] = hops; }
+
+    const double *coordX() const { return coordsX.data(); }
+    const double *coordY() const { return coordsY.data(); }
+    const double *memoryActUsage() const { return memoryActUsages.data(); }
+    const double *memoryMaxUsage() const { return memoryMaxUsages.data(); }
+    const double *compActUsage() const { return compActUsages.data(); }
+    const double *compMaxUsage() const { return compMaxUsages.data(); }
+    const uint8_t *hasCamera() const { return hasCameras.data(); }
+    const uint8_t *lockedCamera() const { return lockedCameras.data(); }
+    const uint8_t *hasGPU() const { return hasGPUs.data(); }
+    const uint8_t *lockedGPU() const { return lockedGPUs.data(); }
+    const uint8_t *lockedFly() const { return lockedFlys.data(); }
+    const double *radius() const { return radiuses.data(); }
+    const std::vector<LoadStep>& getTimeline(int slot) const { return timelines[slot]; }
+
+    /** Column view for CandidateEvaluator; invalidated by the next upsert(). */
+    CandidateColumns columns() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const NodeData& data);
+std::ostream& operator<<(std::ostream& os, const NodeTable& table);
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_NODETABLE_H_ */
@@ -0,0 +1,163 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "OrchestrationRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inet {
+
+Define_Module(OrchestrationRegistry);
+
+void OrchestrationRegistry::initialize()
+{
+    gridCellSize = par("gridCellSize");
+    if (gridCellSize < 0)
+        throw cRuntimeError("Invalid gridCellSize parameter");
+    nodes.setGridCellSize(gridCellSize);
+    WATCH(nodes);
+    WATCH(numQueries);
+}
+
+void OrchestrationRegistry::handleMessage(cMessage *msg)
+{
+    throw cRuntimeError("This module does not process messages");
+}
+
+void OrchestrationRegistry::finish()
+{
+    recordScalar("registry queries", numQueries);
+    recordScalar("registry refreshes", numRefreshes);
+}
+
+int OrchestrationRegistry::registerNode(int index, IOrchestrationMember *member, IMobility *mobility, const NodeData& state)
+{
+    if (index < 0)
+        throw cRuntimeError("Invalid registration index %d", index);
+    if (nodes.contains(state.address))
+        throw cRuntimeError("Node %s is already registered", state.address.str().c_str());
+
+    int slot = nodes.upsert(state.address, state);
+    members.resize(nodes.size());
+    members[slot].member = member;
+    members[slot].mobility = mobility;
+    members[slot].index = index;
+    if (mobility != nullptr) {
+        Coord pos = mobility->getCurrentPosition();
+        nodes.setPosition(slot, pos.x, pos.y);
+        if (mobility->getMaxSpeed() != 0)
+            mobileSlots.push_back(slot);
+    }
+    return slot;
+}
+
+void OrchestrationRegistry::refresh()
+{
+    simtime_t now = simTime();
+    if (now == positionsTime)
+        return;
+    positionsTime = now;
+    for (int slot : mobileSlots) {
+        Coord pos = members[slot].mobility->getCurrentPosition();
+        nodes.setPosition(slot, pos.x, pos.y);
+    }
+    numRefreshes++;
+}
+
+void OrchestrationRegistry::findFeasible(const TaskRequirements& req, simtime_t start, simtime_t end, std::vector<L3Address>& out)
+{
+    numQueries++;
+    candidates.clear();
+    if (req.reqPosition) {
+        refresh();
+        nodes.queryCircle(req.posX, req.posY, req.range, candidates);
+    }
+    else {
+        for (int slot = 0; slot < nodes.size(); ++slot)
+            candidates.push_back(slot);
+    }
+
+    // the capabilities do not change: only the nodes that have them are asked for their peak load
+    const double *compMax = nodes.compMaxUsage();
+    const double *memoryMax = nodes.memoryMaxUsage();
+    const uint8_t *camera = nodes.hasCamera();
+    const uint8_t *gpu = nodes.hasGPU();
+    feasible.clear();
+    NodeData state;
+    for (int slot : candidates) {
+        if (req.reqCPU > compMax[slot] || req.reqMemory > memoryMax[slot]
+                || (req.reqCamera && !camera[slot]) || (req.reqGPU && !gpu[slot]))
+            continue;
+        state = nodes.get(slot);
+        members[slot].member->applyPeakLoad(start, end, state);
+        if (DecisionEngine::isDeployFeasible(req, toCandidateNode(state)))
+            feasible.push_back(std::make_pair(members[slot].index, slot));
+    }
+
+    std::sort(feasible.begin(), feasible.end());
+    for (const auto& f : feasible)
+        out.push_back(nodes.getAddress(f.second));
+}
+
+void OrchestrationRegistry::findRoutes(const L3Address& source, double range, int maxHops, std::vector<Route>& out)
+{
+    int sourceSlot = nodes.find(source);
+    if (sourceSlot < 0)
+        throw cRuntimeError("Node %s is not registered", source.str().c_str());
+    refresh();
+    if (range != gridCellSize) {
+        // the neighbours of a node are then in the 3x3 cells around it
+        nodes.setGridCellSize(range);
+        gridCellSize = range;
+    }
+
+    const double *xs = nodes.coordX();
+    const double *ys = nodes.coordY();
+    double range2 = range * range;
+    hopsOfSlot.assign(nodes.size(), -1);
+    hopsOfSlot[sourceSlot] = 0;
+    size_t first = out.size();
+    out.push_back(Route{sourceSlot, 0, sourceSlot, 0});
+
+    // out is the BFS queue; every node is scanned once, for its radius
+    for (size_t head = first; head < out.size(); ++head) {
+        int uSlot = out[head].slot;
+        int uHops = out[head].hops;
+        int uNextHop = out[head].nextHopSlot;
+        double radius2 = 0;
+
+        candidates.clear();
+        nodes.queryCircle(xs[uSlot], ys[uSlot], range, candidates);
+        // the grid returns the cells in no particular order: keep the tree independent of it
+        std::sort(candidates.begin(), candidates.end());
+        for (int v : candidates) {
+            double dx = xs[v] - xs[uSlot];
+            double dy = ys[v] - ys[uSlot];
+            double d2 = dx * dx + dy * dy;
+            if (v == uSlot || d2 > range2)
+                continue;
+            radius2 = std::max(radius2, d2);
+            if (hopsOfSlot[v] < 0 && (maxHops < 0 || uHops < maxHops)) {
+                hopsOfSlot[v] = uHops + 1;
+                out.push_back(Route{v, uHops + 1, uHops == 0 ? v : uNextHop, 0});
+            }
+        }
+        out[head].radius = std::sqrt(radius2);
+    }
+}
+
+} // namespace inet
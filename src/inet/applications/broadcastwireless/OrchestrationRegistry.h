@@ -0,0 +1,121 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_ORCHESTRATIONREGISTRY_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_ORCHESTRATIONREGISTRY_H_
+
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/mobility/contract/IMobility.h"
+
+#include "NodeTable.h"
+#include "DecisionEngine.h"
+
+namespace inet {
+
+/**
+ * A node registered in an OrchestrationRegistry.
+ */
+class INET_API IOrchestrationMember
+{
+  public:
+    virtual ~IOrchestrationMember() {}
+    /** Overwrites the usage and locks of state with their peak over [start, end) on this node. */
+    virtual void applyPeakLoad(simtime_t start, simtime_t end, NodeData& state) = 0;
+};
+
+/**
+ * Network-level ground truth of the orchestration nodes, for statistics.
+ * See NED for more info.
+ *
+ * The table holds what does not depend on the tasks: the capabilities of
+ * the nodes, given when they register, and their positions, read from the
+ * mobility modules that can move when a query needs them (at most once per
+ * simulation time). The load is asked to the nodes that pass these filters.
+ */
+class INET_API OrchestrationRegistry : public cSimpleModule
+{
+  public:
+    /** A node reachable from the source of findRoutes(). */
+    struct Route
+    {
+        int slot;           // in getNodes()
+        int hops;           // 0 for the source
+        int nextHopSlot;    // first hop of the BFS tree path, the source itself for the source
+        double radius;      // distance to the farthest unit-disk neighbour of the node
+    };
+
+  protected:
+    struct Member
+    {
+        IOrchestrationMember *member = nullptr;
+        IMobility *mobility = nullptr;
+        int index = -1;     // registration index
+    };
+
+    NodeTable nodes;                 // one slot per registered node
+    std::vector<Member> members;     // by slot
+    std::vector<int> mobileSlots;    // slots whose mobility can move
+    simtime_t positionsTime = -1;    // of the last refresh()
+    double gridCellSize = 0;            // of the nodes table, then the range of findRoutes()
+    std::vector<int> hopsOfSlot;        // scratch of findRoutes()
+    std::vector<int> candidates;        // scratch of findRoutes() and findFeasible()
+    std::vector<std::pair<int, int>> feasible; // scratch (index, slot) of findFeasible()
+
+    long numQueries = 0;
+    long numRefreshes = 0;
+
+    virtual void initialize() override;
+    virtual void handleMessage(cMessage *msg) override;
+    virtual void finish() override;
+
+    /** Brings the positions of the mobile nodes up to date, once per simulation time. */
+    void refresh();
+
+  public:
+    OrchestrationRegistry() {}
+
+    /**
+     * Registers a node with its address and capabilities (maximum CPU and
+     * memory, camera, GPU); index orders the query results (e.g. the host
+     * index). Returns the slot of the node.
+     */
+    int registerNode(int index, IOrchestrationMember *member, IMobility *mobility, const NodeData& state);
+
+    /**
+     * Appends to out the nodes that can host a task running over [start, end),
+     * against their peak load over that interval, in registration index order.
+     * Only the nodes within the task circle (from the spatial index) that have
+     * the capabilities required are asked for their load.
+     */
+    void findFeasible(const TaskRequirements& req, simtime_t start, simtime_t end, std::vector<L3Address>& out);
+
+    /**
+     * Breadth-first search from the source over the unit-disk graph of the
+     * current positions (nodes within range are connected). Appends the
+     * nodes reachable in at most maxHops hops (no limit if negative), the
+     * source included, in BFS order.
+     */
+    void findRoutes(const L3Address& source, double range, int maxHops, std::vector<Route>& out);
+
+    int getNumNodes() const { return nodes.size(); }
+    const NodeTable& getNodes() const { return nodes; }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_ORCHESTRATIONREGISTRY_H_ */
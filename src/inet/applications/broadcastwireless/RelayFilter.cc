@@ -0,0 +1,89 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "RelayFilter.h"
+
+namespace inet {
+
+void RelayFilter::configure(uint32_t size, simtime_t horizon)
+{
+    windowSize = (size + 63) / 64 * 64;
+    expiry = horizon;
+    windows.clear();
+}
+
+bool RelayFilter::testAndSet(Window& w, uint32_t id)
+{
+    if (id < w.base) {
+        numBelowWindow++;
+        return false;
+    }
+
+    if (id >= w.base + windowSize) {
+        // slide the window so that id is its last entry, forgetting the ids left behind
+        uint32_t newBase = id - windowSize + 1;
+        if (newBase - w.base >= windowSize) {
+            std::fill(w.bits.begin(), w.bits.end(), 0);
+        }
+        else {
+            for (uint32_t i = w.base; i < newBase; ++i)
+                w.bits[(i % windowSize) >> 6] &= ~(1ULL << (i & 63));
+        }
+        w.base = newBase;
+    }
+
+    uint64_t& word = w.bits[(id % windowSize) >> 6];
+    uint64_t bit = 1ULL << (id & 63);
+    bool fresh = !(word & bit);
+    word |= bit;
+    return fresh;
+}
+
+void RelayFilter::purge(simtime_t now)
+{
+    for (auto it = windows.begin(); it != windows.end(); ) {
+        if (now - it->second.lastUsed > expiry)
+            it = windows.erase(it);
+        else
+            ++it;
+    }
+    lastPurge = now;
+}
+
+bool RelayFilter::insert(const L3Address& generator, uint32_t id, simtime_t now)
+{
+    numQueries++;
+    if (expiry > SIMTIME_ZERO && now - lastPurge > expiry / 2)
+        purge(now);
+
+    auto it = windows.find(generator);
+    if (it == windows.end()) {
+        Window w;
+        w.base = id >= windowSize ? id - windowSize + 1 : 0;
+        w.bits.assign(windowSize / 64, 0);
+        it = windows.emplace(generator, w).first;
+    }
+    it->second.lastUsed = now;
+    return testAndSet(it->second, id);
+}
+
+std::ostream& operator<<(std::ostream& os, const RelayFilter& filter)
+{
+    os << filter.getNumGenerators() << " generators, " << filter.getMemoryBytes() << " bytes, "
+       << filter.getNumQueries() << " queries, " << filter.getNumBelowWindow() << " below window";
+    return os;
+}
+
+} // namespace inet
@@ -0,0 +1,78 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_RELAYFILTER_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_RELAYFILTER_H_
+
+#include <vector>
+#include <unordered_map>
+
+#include "NodeTable.h"
+
+namespace inet {
+
+/**
+ * Duplicate suppression for relayed tasks, keyed by (generator, task id).
+ *
+ * Task ids of a generator are increasing, so each generator only keeps a
+ * sliding window of the last windowSize ids as a bitmap. Ids below the
+ * window are reported as already seen: some of these may be false
+ * positives, and they are counted. Generators that have been idle for
+ * longer than the expiry horizon are dropped.
+ */
+class INET_API RelayFilter
+{
+  protected:
+    struct Window
+    {
+        uint32_t base = 0;           // lowest id inside the window
+        std::vector<uint64_t> bits;  // ring bitmap, id i at bit i % windowSize
+        simtime_t lastUsed;
+    };
+
+    std::unordered_map<L3Address, Window, L3AddressHash> windows;
+    uint32_t windowSize = 1024;
+    simtime_t expiry = 600;
+    simtime_t lastPurge;
+
+    long numQueries = 0;
+    long numBelowWindow = 0;
+
+    bool testAndSet(Window& w, uint32_t id);
+    void purge(simtime_t now);
+
+  public:
+    RelayFilter() {}
+
+    /** windowSize is rounded up to a multiple of 64; an expiry of 0 keeps generators forever. */
+    void configure(uint32_t windowSize, simtime_t expiry);
+
+    /** Marks the id as seen; returns true if it was not seen before. */
+    bool insert(const L3Address& generator, uint32_t id, simtime_t now);
+
+    long getNumQueries() const { return numQueries; }
+    /** Queries answered "seen" only because the id had left the window (upper bound of false positives). */
+    long getNumBelowWindow() const { return numBelowWindow; }
+    /** Fraction of the queries below the window, duplicates included: an upper bound of the false positive rate. */
+    double getBelowWindowRate() const { return numQueries == 0 ? 0 : (double)numBelowWindow / numQueries; }
+    int getNumGenerators() const { return windows.size(); }
+    size_t getMemoryBytes() const { return windows.size() * (sizeof(Window) + windowSize / 8); }
+};
+
+std::ostream& operator<<(std::ostream& os, const RelayFilter& filter);
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_RELAYFILTER_H_ */
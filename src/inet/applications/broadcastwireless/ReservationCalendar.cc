@@ -0,0 +1,261 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "ReservationCalendar.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inet {
+
+void ReservationCalendar::clear()
+{
+    nodes.clear();
+    freeNodes.clear();
+    root = -1;
+}
+
+int ReservationCalendar::newNode(double time, const Load& delta)
+{
+    // xorshift: priorities only need to be well spread, not random-stream quality
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    int n;
+    if (!freeNodes.empty()) {
+        n = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        n = nodes.size();
+        nodes.emplace_back();
+    }
+    Node& node = nodes[n];
+    node.time = time;
+    node.delta = delta;
+    node.priority = seed;
+    node.left = node.right = -1;
+    update(n);
+    return n;
+}
+
+void ReservationCalendar::update(int n)
+{
+    Node& node = nodes[n];
+    for (int r = 0; r < NUM_RESOURCES; ++r) {
+        double s = 0, best;
+        if (node.left >= 0) {
+            best = nodes[node.left].maxPrefix[r];
+            s = nodes[node.left].sum[r];
+            s += node.delta[r];
+            best = std::max(best, s);
+        }
+        else {
+            s = node.delta[r];
+            best = s;
+        }
+        if (node.right >= 0) {
+            best = std::max(best, s + nodes[node.right].maxPrefix[r]);
+            s += nodes[node.right].sum[r];
+        }
+        node.sum[r] = s;
+        node.maxPrefix[r] = best;
+    }
+}
+
+void ReservationCalendar::split(int t, double key, bool inclusive, int& l, int& r)
+{
+    if (t < 0) {
+        l = r = -1;
+        return;
+    }
+    Node& node = nodes[t];
+    bool goesLeft = inclusive ? node.time <= key : node.time < key;
+    if (goesLeft) {
+        split(node.right, key, inclusive, nodes[t].right, r);
+        l = t;
+    }
+    else {
+        split(node.left, key, inclusive, l, nodes[t].left);
+        r = t;
+    }
+    update(t);
+}
+
+int ReservationCalendar::merge(int l, int r)
+{
+    if (l < 0)
+        return r;
+    if (r < 0)
+        return l;
+    if (nodes[l].priority > nodes[r].priority) {
+        nodes[l].right = merge(nodes[l].right, r);
+        update(l);
+        return l;
+    }
+    else {
+        nodes[r].left = merge(l, nodes[r].left);
+        update(r);
+        return r;
+    }
+}
+
+void ReservationCalendar::freeTree(int t)
+{
+    if (t < 0)
+        return;
+    freeTree(nodes[t].left);
+    freeTree(nodes[t].right);
+    freeNodes.push_back(t);
+}
+
+void ReservationCalendar::addChange(double time, const Load& delta)
+{
+    int a, b, c;
+    split(root, time, false, a, b);
+    split(b, time, true, b, c);
+    if (b >= 0) {
+        // a change point at this time already exists (the middle part is that single node)
+        for (int r = 0; r < NUM_RESOURCES; ++r)
+            nodes[b].delta[r] += delta[r];
+        update(b);
+    }
+    else {
+        b = newNode(time, delta);
+    }
+    root = merge(merge(a, b), c);
+}
+
+void ReservationCalendar::reserve(double start, double end, const Load& load)
+{
+    if (!(end > start))
+        return;
+
+    Load minus;
+    for (int r = 0; r < NUM_RESOURCES; ++r)
+        minus[r] = -load[r];
+    addChange(start, load);
+    addChange(end, minus);
+}
+
+ReservationCalendar::Load ReservationCalendar::at(double t)
+{
+    int a, b;
+    split(root, t, true, a, b);
+    Load load;
+    if (a >= 0)
+        load = nodes[a].sum;
+    root = merge(a, b);
+    return load;
+}
+
+ReservationCalendar::Load ReservationCalendar::peak(double start, double end)
+{
+    int a, b, c;
+    split(root, start, true, a, b);
+    split(b, end, false, b, c);
+
+    // load at start, raised by any higher prefix inside (start, end)
+    Load load;
+    for (int r = 0; r < NUM_RESOURCES; ++r) {
+        double base = a >= 0 ? nodes[a].sum[r] : 0;
+        double inside = b >= 0 ? std::max(0.0, nodes[b].maxPrefix[r]) : 0;
+        load[r] = base + inside;
+    }
+
+    root = merge(merge(a, b), c);
+    return load;
+}
+
+double ReservationCalendar::nextChange(double t) const
+{
+    double next = INFINITY;
+    for (int n = root; n >= 0; ) {
+        if (nodes[n].time > t) {
+            next = nodes[n].time;
+            n = nodes[n].left;
+        }
+        else
+            n = nodes[n].right;
+    }
+    return next;
+}
+
+void ReservationCalendar::advance(double now)
+{
+    int a, b;
+    split(root, now, true, a, b);
+    if (a < 0) {
+        root = b;
+        return;
+    }
+
+    Load load = nodes[a].sum;
+    freeTree(a);
+    a = -1;
+
+    // what is left of the reservations that have ended is rounding residue
+    bool any = false;
+    for (int r = 0; r < NUM_RESOURCES; ++r) {
+        if (std::fabs(load[r]) < 1e-9)
+            load[r] = 0;
+        any |= load[r] != 0;
+    }
+    if (any)
+        a = newNode(now, load);
+    root = merge(a, b);
+}
+
+void ReservationCalendar::steps(double from, int max, std::vector<std::pair<double, Load>>& out) const
+{
+    if (max <= 0)
+        return;
+
+    // in-order walk with an explicit stack, accumulating the load
+    Load load;
+    bool started = false;
+    int count = 0;
+    std::vector<int> stack;
+    int t = root;
+    while ((t >= 0 || !stack.empty()) && count < max) {
+        while (t >= 0) {
+            stack.push_back(t);
+            t = nodes[t].left;
+        }
+        t = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[t];
+        if (node.time > from && !started) {
+            out.push_back(std::make_pair(from, load));
+            started = true;
+            if (++count == max)
+                break;
+        }
+        for (int r = 0; r < NUM_RESOURCES; ++r)
+            load[r] += node.delta[r];
+        if (started) {
+            out.push_back(std::make_pair(node.time, load));
+            ++count;
+        }
+        t = node.right;
+    }
+    if (!started && count < max)
+        out.push_back(std::make_pair(from, load));
+}
+
+} // namespace inet
@@ -0,0 +1,106 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_RESERVATIONCALENDAR_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_RESERVATIONCALENDAR_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// NOTE: this file must not depend on OMNeT++/INET headers, it is also built by bench/
+
+namespace inet {
+
+/**
+ * Load of the tasks reserved on a node, as a step function of time.
+ *
+ * Each reservation adds its load at its start time and removes it at its end
+ * time. The change points are kept in a treap ordered by time; every subtree
+ * knows the sum of its changes and the highest prefix sum, per resource, so
+ * the peak load over any interval is found in O(log n). Locks are counted
+ * like the other resources: a peak above zero means locked.
+ */
+class ReservationCalendar
+{
+  public:
+    enum Resource { CPU, MEMORY, GPU, CAMERA, FLY, NUM_RESOURCES };
+
+    struct Load
+    {
+        double v[NUM_RESOURCES] = {};
+
+        double& operator[](int r) { return v[r]; }
+        double operator[](int r) const { return v[r]; }
+    };
+
+  protected:
+    struct Node
+    {
+        double time;
+        Load delta;      // change of the load at this time
+        Load sum;        // of the deltas of the subtree
+        Load maxPrefix;  // highest prefix sum of the subtree (over non-empty prefixes)
+        uint32_t priority;
+        int left, right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root = -1;
+    uint32_t seed = 0x9e3779b9u;
+
+    int newNode(double time, const Load& delta);
+    void update(int n);
+    // splits t into the nodes with time < key (or <= key if inclusive) and the others
+    void split(int t, double key, bool inclusive, int& l, int& r);
+    int merge(int l, int r);
+    void freeTree(int t);
+    void addChange(double time, const Load& delta);
+
+  public:
+    ReservationCalendar() {}
+
+    void clear();
+    /** Number of change points held. */
+    int size() const { return nodes.size() - freeNodes.size(); }
+
+    /** Adds load over [start, end); nothing if end <= start. */
+    void reserve(double start, double end, const Load& load);
+
+    /** Load at time t. */
+    Load at(double t);
+    /** Highest load over [start, end), per resource. */
+    Load peak(double start, double end);
+    /** Time of the first change point after t, +inf if none. */
+    double nextChange(double t) const;
+
+    /**
+     * Folds the change points up to now into a single one, so that the size
+     * of the calendar follows the reservations that have not ended yet.
+     */
+    void advance(double now);
+
+    /**
+     * Appends to out the load at from and after each of the following change
+     * points, as (time, load), at most max entries.
+     */
+    void steps(double from, int max, std::vector<std::pair<double, Load>>& out) const;
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_RESERVATIONCALENDAR_H_ */
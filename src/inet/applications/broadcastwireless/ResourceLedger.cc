@@ -0,0 +1,87 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "ResourceLedger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inet {
+
+void ResourceLedger::refresh(simtime_t now)
+{
+    // folding the past change points leaves the current load without rounding residue
+    calendar.advance(now.dbl());
+    current = calendar.at(now.dbl());
+    double next = calendar.nextChange(now.dbl());
+    nextChange = std::isinf(next) ? SIMTIME_MAX : SimTime(next);
+}
+
+bool ResourceLedger::add(const L3Address& gen, uint32_t id, double cpu, double memory, bool lockGPU, bool lockCamera, bool lockFly,
+        simtime_t start, simtime_t end, simtime_t now)
+{
+    TaskKey key{gen, id};
+    if (!deployed.insert(key).second)
+        return false;
+    numAdded++;
+    if (expiry > 0)
+        expiries.push(Expiry(std::max(end, now) + expiry, key));
+
+    if (end <= now || end <= start)
+        return true; // never active from now on
+
+    ReservationCalendar::Load load;
+    load[ReservationCalendar::CPU] = cpu;
+    load[ReservationCalendar::MEMORY] = memory;
+    load[ReservationCalendar::GPU] = lockGPU;
+    load[ReservationCalendar::CAMERA] = lockCamera;
+    load[ReservationCalendar::FLY] = lockFly;
+    calendar.reserve(std::max(start, now).dbl(), end.dbl(), load);
+    refresh(now);
+    return true;
+}
+
+void ResourceLedger::advance(simtime_t now)
+{
+    while (!expiries.empty() && expiries.top().first <= now) {
+        deployed.erase(expiries.top().second);
+        expiries.pop();
+    }
+    if (now >= nextChange)
+        refresh(now);
+}
+
+void ResourceLedger::upcomingSteps(simtime_t now, int max, std::vector<std::pair<double, ReservationCalendar::Load>>& out) const
+{
+    if (max <= 0)
+        return;
+    // the first step of the calendar is the current load
+    size_t first = out.size();
+    calendar.steps(now.dbl(), max + 1, out);
+    out.erase(out.begin() + first);
+}
+
+std::ostream& operator<<(std::ostream& os, const ResourceLedger& ledger)
+{
+    os << ledger.getNumDeployed() << " deployed, " << ledger.getNumChanges() << " change points; cpu " << ledger.getCompUsage()
+            << ", memory " << ledger.getMemoryUsage()
+            << (ledger.isGPULocked() ? ", GPU locked" : "")
+            << (ledger.isCameraLocked() ? ", camera locked" : "")
+            << (ledger.isFlyLocked() ? ", fly locked" : "");
+    return os;
+}
+
+} // namespace inet
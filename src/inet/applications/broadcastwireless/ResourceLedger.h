@@ -0,0 +1,114 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_RESOURCELEDGER_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_RESOURCELEDGER_H_
+
+#include <queue>
+#include <unordered_set>
+#include <vector>
+
+#include "NodeTable.h"
+#include "ReservationCalendar.h"
+
+namespace inet {
+
+/**
+ * Resources used by the tasks deployed on this node.
+ *
+ * A task uses its CPU, memory and locks while start <= now < end. The load
+ * is held by a ReservationCalendar, which also answers the peak over the
+ * lifetime of a new task; the load at the current time is cached until the
+ * next start or end, so it is available in O(1) between changes. Tasks are
+ * dropped once they end; only their (generator, id) key is remembered, for
+ * the duplicate check, and it is forgotten too once the task has been over
+ * for longer than the expiry.
+ */
+class INET_API ResourceLedger
+{
+  protected:
+    struct TaskKey
+    {
+        L3Address gen;
+        uint32_t id;
+        bool operator==(const TaskKey& o) const { return id == o.id && gen == o.gen; }
+    };
+    struct TaskKeyHash
+    {
+        size_t operator()(const TaskKey& k) const { return L3AddressHash()(k.gen) * 31 + k.id; }
+    };
+
+    typedef std::pair<simtime_t, TaskKey> Expiry;
+    struct LaterExpiry
+    {
+        bool operator()(const Expiry& a, const Expiry& b) const { return a.first > b.first; }
+    };
+
+    std::unordered_set<TaskKey, TaskKeyHash> deployed;
+    std::priority_queue<Expiry, std::vector<Expiry>, LaterExpiry> expiries; // of the keys in deployed
+    simtime_t expiry = 0; // 0: keys are never forgotten
+    long numAdded = 0;
+    ReservationCalendar calendar;
+    ReservationCalendar::Load current; // load at the last advance()
+    simtime_t nextChange = SIMTIME_MAX; // first start or end after it
+
+    void refresh(simtime_t now);
+
+  public:
+    ResourceLedger() {}
+
+    /** How long after its end the key of a task is remembered; 0 means forever. */
+    void setExpiry(simtime_t expiry) { this->expiry = expiry; }
+
+    /** True if a task with this key was added and its key has not expired yet, even if it has ended. */
+    bool contains(const L3Address& gen, uint32_t id) const { return deployed.count(TaskKey{gen, id}) != 0; }
+
+    /**
+     * Records a deployed task; returns false (and records nothing) if its key
+     * is already known. now must not be earlier than in previous calls.
+     */
+    bool add(const L3Address& gen, uint32_t id, double cpu, double memory, bool lockGPU, bool lockCamera, bool lockFly,
+            simtime_t start, simtime_t end, simtime_t now);
+
+    /** Brings the current load to now, releasing the tasks that have ended and the expired keys. */
+    void advance(simtime_t now);
+
+    /** Highest load over [start, end), start not earlier than the last advance(). */
+    ReservationCalendar::Load peak(simtime_t start, simtime_t end) { return calendar.peak(start.dbl(), end.dbl()); }
+    /**
+     * Appends to out the load after each of the next max starts or ends of
+     * tasks after now, as (time, load); now as in the last advance().
+     */
+    void upcomingSteps(simtime_t now, int max, std::vector<std::pair<double, ReservationCalendar::Load>>& out) const;
+
+    double getCompUsage() const { return current[ReservationCalendar::CPU]; }
+    double getMemoryUsage() const { return current[ReservationCalendar::MEMORY]; }
+    bool isGPULocked() const { return current[ReservationCalendar::GPU] > 0; }
+    bool isCameraLocked() const { return current[ReservationCalendar::CAMERA] > 0; }
+    bool isFlyLocked() const { return current[ReservationCalendar::FLY] > 0; }
+    /** Number of keys remembered for the duplicate check. */
+    int getNumDeployed() const { return deployed.size(); }
+    /** Number of tasks added since the start. */
+    long getNumAdded() const { return numAdded; }
+    /** Number of change points of the tasks that have not ended. */
+    int getNumChanges() const { return calendar.size(); }
+};
+
+std::ostream& operator<<(std::ostream& os, const ResourceLedger& ledger);
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_RESOURCELEDGER_H_ */
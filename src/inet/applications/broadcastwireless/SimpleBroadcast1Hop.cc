@@ -36,24 +36,7 @@
 #include "inet/transportlayer/common/L4PortTag_m.h"
 #include "inet/common/ModuleAccess.h"
 
-
-static bool gEnableDebug = false;
-static inline void debugPrint(const char* fmt, ...)
-{
-    if (!gEnableDebug)
-        return;
-
-    va_list args;
-    va_start(args, fmt);
-    vprintf(fmt, args);
-    va_end(args);
-    fflush(stdout);
-}
-
-//...
-//
-//// Then use:
-//debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::begin\n");
+#include "BroadcastLog.h"
 
 
 namespace inet {
@@ -61,6 +44,16 @@ namespace inet {
 Define_Module(SimpleBroadcast1Hop);
 
 //simsignal_t SimpleBroadcast1Hop::taskDeploymentTimeSignal = registerSignal("tDeploymentTimeSignal");
+simsignal_t SimpleBroadcast1Hop::taskGeneratedSignal = registerSignal("taskGenerated");
+simsignal_t SimpleBroadcast1Hop::taskDeployedSignal = registerSignal("taskDeployed");
+simsignal_t SimpleBroadcast1Hop::taskAckedSignal = registerSignal("taskAcked");
+simsignal_t SimpleBroadcast1Hop::infoPacketSentSignal = registerSignal("infoPacketSent");
+
+const char *const SimpleBroadcast1Hop::traceEventNames[] = {
+    "heartbeatSent", "heartbeatReceived", "changesSent", "changesReceived",
+    "taskSent", "taskReceived", "ackSent", "ackReceived", "ackExpired",
+    "taskDeployed", "decision"
+};
 
 SimpleBroadcast1Hop::~SimpleBroadcast1Hop()
 {
@@ -68,6 +61,7 @@ SimpleBroadcast1Hop::~SimpleBroadcast1Hop()
     cancelAndDelete(taskMsg);
     cancelAndDelete(taskForwardMsg);
     cancelAndDelete(taskAckMsg);
+    cancelAndDelete(replayMsg);
 }
 
 void SimpleBroadcast1Hop::initialize(int stage)
@@ -113,9 +107,9 @@ void SimpleBroadcast1Hop::initialize(int stage)
         WATCH(numSent);
         WATCH(numReceived);
 
-        WATCH_MAP(nodeDataMap);
-        WATCH_VECTOR(assignedTask_list);
-        WATCH_SET(relayedPackets);
+        WATCH(nodeTable);
+        WATCH(relayFilter);
+        WATCH(resourceLedger);
 
         localPort = par("localPort");
         destPort = par("destPort");
@@ -131,6 +125,48 @@ void SimpleBroadcast1Hop::initialize(int stage)
 
         startMakingStats = par("startMakingStats");
 
+        const char *tableMode = par("initialTableMode");
+        if (!strcmp(tableMode, "convergent"))
+            initialTableMode = TABLE_CONVERGENT;
+        else if (!strcmp(tableMode, "oracle"))
+            initialTableMode = TABLE_ORACLE;
+        else
+            throw cRuntimeError("Invalid initialTableMode parameter: '%s'", tableMode);
+
+        nodeTable.setGridCellSize(par("gridCellSize").doubleValue());
+        decisionCache.setMaxEntries(par("decisionCacheSize").intValue());
+        taskRng = par("taskRng");
+        forwardingRng = par("forwardingRng");
+        placementRng = par("placementRng");
+        placementPolicy.gammaAlmostAll = par("gamma_almost_all");
+        placementPolicy.gammaAtLeastOne = par("gamma_at_least_one");
+        if (dissType == PROGRESSIVE)
+            nodeTable.addListener(&neighbourAggregates);
+        registerPacketHandlers();
+
+        int relayFilterWindow = par("relayFilterWindow");
+        if (relayFilterWindow <= 0)
+            throw cRuntimeError("Invalid relayFilterWindow parameter");
+        relayFilter.configure(relayFilterWindow, par("relayFilterExpiry"));
+        capacityTimelineSteps = par("capacityTimelineSteps");
+        if (capacityTimelineSteps < 0)
+            throw cRuntimeError("Invalid capacityTimelineSteps parameter");
+        resourceLedger.setExpiry(par("deployedTaskExpiry"));
+
+        int traceRingSize = par("traceRingSize");
+        if (traceRingSize < 0)
+            throw cRuntimeError("Invalid traceRingSize parameter");
+        traceRing.setCapacity(traceRingSize);
+        traceRingFile = par("traceRingFile").stdstringValue();
+
+        std::string replayFile = par("replayFile").stdstringValue();
+        if (!replayFile.empty()) {
+            replaying = true;
+            replayLog.open(replayFile + "." + getParentModule()->getFullName());
+            replayMsg = new cMessage("replayTimer");
+            replayMsg->setSchedulingPriority(-1); // the recorded position holds for the events of the same time
+        }
+
         if (stopTime >= CLOCKTIME_ZERO && stopTime < startTime)
             throw cRuntimeError("Invalid startTime/stopTime parameters");
         selfMsg = new ClockEvent("sendTimer");
@@ -140,13 +176,24 @@ void SimpleBroadcast1Hop::initialize(int stage)
 
 
     }
-    else if (stage == INITSTAGE_LAST){
+    else if (stage == INITSTAGE_APPLICATION_LAYER){
+        // resolved before INITSTAGE_LAST, where the registry has to know all the nodes (initialTableMode)
         mob = check_and_cast<IMobility *>(this->getParentModule()->getSubmodule("mobility"));
 
         EV_INFO << "Node position is: " << mob->getCurrentPosition() << endl;
 
-        // Obtain the IP address
-        myAddress = L3AddressResolver().addressOf(getParentModule(), L3AddressResolver::ADDR_IPv4);
+        if (replaying) {
+            // the node as it was recorded, without network interfaces
+            replayMobility = dynamic_cast<ReplayMobility *>(mob);
+            if (replayMobility == nullptr)
+                throw cRuntimeError("Replaying an input log needs a ReplayMobility");
+            replayMobility->setPosition(replayLog.getPosition());
+            myAddress = replayLog.getAddress();
+        }
+        else {
+            // Obtain the IP address
+            myAddress = L3AddressResolver().addressOf(getParentModule(), L3AddressResolver::ADDR_IPv4);
+        }
 
         myAppAddr = this->getParentModule()->getIndex();
 
@@ -154,533 +201,275 @@ void SimpleBroadcast1Hop::initialize(int stage)
         EV_INFO << "My IP address is: " << myAddress.str() << endl;
         EV_INFO << "My APP address is: " << myAppAddr << endl;
 
-    }
-}
-
-void SimpleBroadcast1Hop::finish()
-{
-    recordScalar("packets sent", numSent);
-    recordScalar("packets received", numReceived);
-    recordScalar("Info-layer packets sent", netPktSent);
-    recordScalar("Info-layer traffic size", netPktSize);
-
-    int sumNetPktSent = 0;
-    long sumNetPktSize = 0;
-
-    if (myAppAddr == 0) {
-        int nnodes = this->getParentModule()->getVectorSize();
-        double total_task_deployed = 0;
-        double total_task_generated = 0;
-
-        std::vector<TaskREQ> full_generatedTask_list;
-        std::map<std::pair<L3Address, uint32_t>, Task_generated_extra_info> full_generatedTask_info_list;
-
-        std::map<std::pair<L3Address, uint32_t>, int> n_deply_per_task;
-        std::map<std::pair<L3Address, uint32_t>, std::vector<double>> time_n_deply_per_task;
-        std::map<std::pair<L3Address, uint32_t>, std::vector<L3Address>> location_deply_per_task;
-
-        std::map<std::pair<L3Address, uint32_t>, Task_Generated_stat_info> extra_info_per_task;
-
-        for (int n = 0; n < nnodes; ++n) {
-            SimpleBroadcast1Hop *appn = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n)->getSubmodule("app", 0));
-            L3Address n_ipaddr = appn->myAddress;
-
-            EV_INFO << "Host " << n << " has IP address: " << n_ipaddr.str() << endl;
-
-            full_generatedTask_list.insert(full_generatedTask_list.end(), appn->generatedTask_list.begin(), appn->generatedTask_list.end());
-            //full_generatedTask_info_list.insert(full_generatedTask_info_list.end(), appn->extra_info_generated_tasks.begin(), appn->extra_info_generated_tasks.end());
-            for (const auto & kv : appn->extra_info_generated_tasks) {
-                // Overwrite duplicates from appn->extra_info_generated_tasks:
-                full_generatedTask_info_list[kv.first] = kv.second;
-            }
-
-            for (auto& t : appn->generatedTask_list) {
-                std::pair<L3Address, uint32_t> key_map = std::make_pair(t.getGen_ipAddress(), t.getId());
-                n_deply_per_task[key_map] = 0;
-                time_n_deply_per_task[key_map] = std::vector<double>();
-                location_deply_per_task[key_map] = std::vector<L3Address>();
-                extra_info_per_task[key_map].generation_time = t.getGen_timestamp();
-                extra_info_per_task[key_map].gen_address = t.getGen_ipAddress();
-                extra_info_per_task[key_map].id_task = t.getId();
-                extra_info_per_task[key_map].strategy = t.getStrategy();
-            }
-
-            total_task_deployed += appn->assignedTask_list.size();
-            total_task_generated += appn->generatedTask_list.size();
-
-        }
-
-        for (int n = 0; n < nnodes; ++n) {
-            SimpleBroadcast1Hop *appn = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n)->getSubmodule("app", 0));
-            L3Address n_ipaddr = appn->myAddress;
-            sumNetPktSent += appn->netPktSent - appn->netPktSent_beforeStart;
-            sumNetPktSize += appn->netPktSize - appn->netPktSize_beforeStart;;
-
-
-
-            for (auto& t_deploy : appn->assignedTask_list) {
-                std::pair<L3Address, uint32_t> key_map = std::make_pair(t_deploy.getGen_ipAddress(), t_deploy.getId());
-
-                n_deply_per_task[key_map] += 1;
-
-
-                double time_to_deploy = (appn->extra_info_deploy_tasks[key_map].deploy_time - full_generatedTask_info_list[key_map].generation_time).dbl();
-                time_n_deply_per_task[key_map].push_back(time_to_deploy);
-                location_deply_per_task[key_map].push_back(n_ipaddr);
-
-                Task_Deployed_stat_info si;
-                si.add_deploy_node = n_ipaddr;
-                si.deploy_time = time_to_deploy;
-                si.node_pos_coord_x = appn->extra_info_deploy_tasks[key_map].node_pos_coord_x;
-                si.node_pos_coord_y = appn->extra_info_deploy_tasks[key_map].node_pos_coord_y;
-                si.num_hops_to_deploy = appn->extra_info_deploy_tasks[key_map].deploy_hops;
-                extra_info_per_task[key_map].extra_info.push_back(si);
-            }
-        }
-
-
-        std::vector<L3Address> onlyExpected_all;
-        std::vector<L3Address> onlyActual_all;
-        std::vector<L3Address> both_all;
-        std::vector<double> onlyExpected_all_size;
-        std::vector<double> onlyActual_all_size;
-        std::vector<double> both_all_size;
-
-        //printf("Test1"); fflush(stdout);
-
-        for (int n = 0; n < nnodes; ++n) {
-            SimpleBroadcast1Hop *appn = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n)->getSubmodule("app", 0));
-            L3Address n_ipaddr = appn->myAddress;
-
-            //printf("Test1_1"); fflush(stdout);
+        registry = findModuleFromPar<OrchestrationRegistry>(par("registryModule"), this);
+        if (registry != nullptr)
+            registry->registerNode(myAppAddr, this, mob, getMyNodeData());
 
-            for (auto& gt : appn->generatedTask_list) {
-                std::pair<L3Address, uint32_t> key_map = std::make_pair(gt.getGen_ipAddress(), gt.getId());
-
-                std::vector<L3Address> expected_deployments = appn->extra_info_generated_tasks[key_map].deployable_nodes_at_generation;
-
-                //printf("Test1_1_1"); fflush(stdout);
-
-                std::vector<L3Address> actual_deployments;
-                for (int n2 = 0; n2 < nnodes; ++n2) {
-                    SimpleBroadcast1Hop *appn2 = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n2)->getSubmodule("app", 0));
-                    L3Address n_ipaddr2 = appn2->myAddress;
-
-                    if (appn2->extra_info_deploy_tasks.count(key_map) != 0) {
-                        actual_deployments.push_back(n_ipaddr2);
-                    }
-                }
-
-                //printf("Test1_1_2"); fflush(stdout);
-
-                if (actual_deployments.size() > 0) {
-
-                    std::vector<L3Address> onlyExpected;
-                    std::vector<L3Address> onlyActual;
-                    std::vector<L3Address> both;
-
-                    for (const auto &e : expected_deployments) {
-                        // Check if e is in actual_deployments
-                        bool found = (std::find(actual_deployments.begin(), actual_deployments.end(), e) != actual_deployments.end());
-                        if (found) {
-                            both.push_back(e);
-                        } else {
-                            onlyExpected.push_back(e);
-                        }
-                    }
-
-                    //printf("Test1_1_3"); fflush(stdout);
-
-                    for (const auto &a : actual_deployments) {
-                        // Check if a is in expected_deployments
-                        bool found = (std::find(expected_deployments.begin(), expected_deployments.end(), a)
-                                != expected_deployments.end());
-                        if (!found) {
-                            onlyActual.push_back(a);
-                        }
-                    }
-
-                    //printf("Test1_1_4"); fflush(stdout);
-
-                    onlyExpected_all.insert(onlyExpected_all.end(), onlyExpected.begin(), onlyExpected.end());
-                    onlyActual_all.insert(onlyActual_all.end(), onlyActual.begin(), onlyActual.end());
-                    both_all.insert(both_all.end(), both.begin(), both.end());
-
-                    //printf("Test1_1_5"); fflush(stdout);
-
-                    if ((onlyExpected.size() + both.size()) > 0) {
-                        double sss = onlyExpected.size() + both.size();
-                        double oe = onlyExpected.size() / sss;;
-                        double oa = onlyActual.size() / sss;
-                        double b = both.size() / sss;
-
-                        printf("TASK:%s-%d\n", key_map.first.str().c_str(), key_map.second);
-                        printf("OE:"); for (auto& el : onlyExpected) printf("%s - ", el.str().c_str()); printf("\n");
-                        printf("OA:"); for (auto& el : onlyActual) printf("%s - ", el.str().c_str()); printf("\n");
-                        printf("B:"); for (auto& el : both) printf("%s - ", el.str().c_str()); printf("\n");
-                        printf("onlyExpected: %f \n", oe);
-                        printf("onlyActual: %f \n", oa);
-                        printf("both: %f \n\n", b);
-
-                        onlyExpected_all_size.push_back(oe);
-                        onlyActual_all_size.push_back(oa);
-                        both_all_size.push_back(b);
-
-//                        onlyExpected_all_size.push_back(onlyExpected.size());
-//                        onlyActual_all_size.push_back(onlyActual.size());
-//                        both_all_size.push_back(both.size());
-                    }
-
-                    //printf("Test1_1_6"); fflush(stdout);
-                }
-
-            }
-
-            //printf("Test1_2"); fflush(stdout);
+        std::string inputLogFile = par("inputLogFile").stdstringValue();
+        if (!inputLogFile.empty()) {
+            checkRngIsolation(getSimulation()->getSystemModule());
+            // one file per host, next to each other
+            inputLog.open(inputLogFile + "." + getParentModule()->getFullName(), myAddress, myAppAddr,
+                    mob->getCurrentPosition(), par("inputLogBlockSize").intValue());
         }
-
-        //printf("Test2"); fflush(stdout);
-
-
-        recordScalar("expected only deployment total", onlyExpected_all.size());
-        recordScalar("actual only deployment total", onlyActual_all.size());
-        recordScalar("expected and actual deployment total", both_all.size());
-
-
-        double expected_size = 0;
-        double actual_size = 0;
-        double both_size = 0;
-
-        if (onlyExpected_all_size.size() > 0) {
-            double sum = std::accumulate(onlyExpected_all_size.begin(), onlyExpected_all_size.end(), 0.0);
-            expected_size = sum / onlyExpected_all_size.size();
-        }
-        if (onlyActual_all_size.size() > 0) {
-            double sum = std::accumulate(onlyActual_all_size.begin(), onlyActual_all_size.end(), 0.0);
-            actual_size = sum / onlyActual_all_size.size();
-        }
-        if (both_all_size.size() > 0) {
-            double sum = std::accumulate(both_all_size.begin(), both_all_size.end(), 0.0);
-            both_size = sum / both_all_size.size();
-        }
-
-        recordScalar("expected only deployment size total", expected_size);
-        recordScalar("actual only deployment size total", actual_size);
-        recordScalar("expected and actual deployment size total", both_size);
-
-
-
-
-        int n_deployed_at_least_1 = 0;
-        for (const auto & kv : n_deply_per_task) {
-            if (kv.second > 1) n_deployed_at_least_1 += 1;
-        }
-
-        double ratio_task_deployed_at_least_1_total = 1;
-        if (total_task_generated > 0) ratio_task_deployed_at_least_1_total = n_deployed_at_least_1/total_task_generated;
-
-        double ratio_task_deployed_total = 1;
-        if (total_task_generated > 0) ratio_task_deployed_total = total_task_deployed/total_task_generated;
-
-        recordScalar("task generated total", total_task_generated);
-        recordScalar("task deployed total", total_task_deployed);
-        recordScalar("ratio task deployed total", ratio_task_deployed_total);
-        recordScalar("ratio task deployed at_least_1 total", ratio_task_deployed_at_least_1_total);
-
-        double avg_delay = 0;
-        std::vector<double> vall;
-        for (auto& el : time_n_deply_per_task){
-            vall.insert(vall.end(), el.second.begin(), el.second.end());
-        }
-        if (vall.size() > 0) {
-            double sum = std::accumulate(vall.begin(), vall.end(), 0.0);
-            avg_delay = sum / vall.size();
-        }
-        recordScalar("task deployed time avg", avg_delay);
-
-
-        for (auto& tg : full_generatedTask_list) {
-            std::pair<L3Address, uint32_t> key_map = std::make_pair(tg.getGen_ipAddress(), tg.getId());
-
-            printf("TASK:%s-%d DEPLOYED IN:\n", key_map.first.str().c_str(), key_map.second);
-            for (auto& dd : location_deply_per_task[key_map]) {
-                printf("node:%s - ", dd.str().c_str());
-            }
-            printf("\n");
+    }
+    else if (stage == INITSTAGE_LAST){
+        // restores the warm-up state when continuing a snapshot
+        snapshot = findModuleFromPar<WarmupSnapshot>(par("snapshotModule"), this);
+        if (snapshot != nullptr)
+            snapshot->registerMember(myAppAddr, this, mob);
+
+        if (initialTableMode == TABLE_ORACLE) {
+            if (snapshot != nullptr && snapshot->isLoading())
+                throw cRuntimeError("initialTableMode = \"oracle\" cannot be used when continuing a warm-up snapshot");
+            fillOracleTable();
         }
 
+        if (replaying)
+            scheduleNextReplay();
+    }
+}
 
-        //#########################################################################################
-        //#########################################################################################
-        //#########################################################################################
-
-        // remake of stats
-        printf("\n\nGOOD STATS\n");
-        double ok_total_task_generated = full_generatedTask_list.size();
-        double ok_total_task_deployed = 0;
-        double ok_task_deployed_atleast1_if_deployable = 0;
-        double ok_task_deployed_atleast1 = 0;
-        double ok_task_deployed_sum_if_deployable = 0;
-        double ok_total_task_generated_deployable = 0;
-
-        double ok_task_deployed_latency_sum = 0;
-
-        double ok_task_deployed_hops_sum = 0;
-
-        std::vector<double> ok_onlyExpected_all_size;
-        std::vector<double> ok_onlyActual_all_size;
-        std::vector<double> ok_both_all_size;
-        std::vector<double> ok_onlyExpectedDecision_all_size;
-        std::vector<double> ok_onlyActualDecision_all_size;
-        std::vector<double> ok_bothDecision_all_size;
-
-        for (auto& tg : full_generatedTask_list) {
-            std::pair<L3Address, uint32_t> key_map = std::make_pair(tg.getGen_ipAddress(), tg.getId());
-            Task_Generated_stat_info act_stat = extra_info_per_task[key_map];
-            Task_generated_extra_info task_stat = full_generatedTask_info_list[key_map];
-
-
-
-
-
-
-
-
-            printf("  TASK:%s-%d, strategy %d. Generated at time %s.\n",
-                    key_map.first.str().c_str(), key_map.second, act_stat.strategy, act_stat.generation_time.str().c_str());
-
-            std::vector<L3Address> expected_deployments = task_stat.deployable_nodes_at_generation;
-            printf("  Deployable nodes: ");
-            for (auto& dn : task_stat.deployable_nodes_at_generation){
-                printf("%s ", dn.str().c_str());
-            }
-            printf("\n");
-
-            std::vector<L3Address> decision_deployments = task_stat.decision_nodes_at_generation;
-            printf("  Decision where to deploy nodes: ");
-            for (auto& dn : task_stat.decision_nodes_at_generation){
-                printf("%s ", dn.str().c_str());
-            }
-            printf("\n");
-
-            std::vector<L3Address> actual_deployments;
-            printf("  Deployed in:\n");
-            for (auto& dd : act_stat.extra_info) {
-                ok_total_task_deployed++;
-                ok_task_deployed_latency_sum += dd.deploy_time.dbl();
-                ok_task_deployed_hops_sum += dd.num_hops_to_deploy;
-                actual_deployments.push_back(dd.add_deploy_node);
-
-                printf("    node:%s; deploy time:%s \n",
-                        dd.add_deploy_node.str().c_str(), dd.deploy_time.str().c_str());
-            }
-            //printf("\n");
-
-
-            if (task_stat.deployable_nodes_at_generation.size() > 0) {
-                ok_total_task_generated_deployable++;
-
-                if (act_stat.extra_info.size() > 0) {
-                    ok_task_deployed_atleast1_if_deployable++;
-                }
-                ok_task_deployed_sum_if_deployable += act_stat.extra_info.size();
-            }
-
-            if (act_stat.extra_info.size() > 0) {
-                ok_task_deployed_atleast1++;
-            }
-
-
-            if (actual_deployments.size() > 0) {
-
-                std::vector<L3Address> onlyExpected;
-                std::vector<L3Address> onlyActual;
-                std::vector<L3Address> both;
-
-                for (const auto &e : expected_deployments) {
-                    // Check if e is in actual_deployments
-                    bool found = (std::find(actual_deployments.begin(), actual_deployments.end(), e) != actual_deployments.end());
-                    if (found) {
-                        both.push_back(e);
-                    } else {
-                        onlyExpected.push_back(e);
-                    }
-                }
-
-                for (const auto &a : actual_deployments) {
-                    // Check if a is in expected_deployments
-                    bool found = (std::find(expected_deployments.begin(), expected_deployments.end(), a)
-                            != expected_deployments.end());
-                    if (!found) {
-                        onlyActual.push_back(a);
-                    }
-                }
-
-
-                if ((onlyExpected.size() + both.size()) > 0) {
-                    double sss = onlyExpected.size() + both.size();
-                    double oe = onlyExpected.size() / sss;;
-                    double oa = onlyActual.size() / sss;
-                    double b = both.size() / sss;
-
-                    printf("      TASK:%s-%d\n", key_map.first.str().c_str(), key_map.second);
-                    printf("      OE:"); for (auto& el : onlyExpected) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      OA:"); for (auto& el : onlyActual) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      B:"); for (auto& el : both) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      onlyExpected: %f \n", oe);
-                    printf("      onlyActual: %f \n", oa);
-                    printf("      both: %f \n\n", b);
-
-                    ok_onlyExpected_all_size.push_back(oe);
-                    ok_onlyActual_all_size.push_back(oa);
-                    ok_both_all_size.push_back(b);
-
-                }
-            }
-
-            if (actual_deployments.size() > 0) {
-
-                std::vector<L3Address> onlyExpected;
-                std::vector<L3Address> onlyActual;
-                std::vector<L3Address> both;
-
-                for (const auto &e : decision_deployments) {
-                    // Check if e is in actual_deployments
-                    bool found = (std::find(actual_deployments.begin(), actual_deployments.end(), e) != actual_deployments.end());
-                    if (found) {
-                        both.push_back(e);
-                    } else {
-                        onlyExpected.push_back(e);
-                    }
-                }
-
-                for (const auto &a : actual_deployments) {
-                    // Check if a is in expected_deployments
-                    bool found = (std::find(decision_deployments.begin(), decision_deployments.end(), a)
-                            != decision_deployments.end());
-                    if (!found) {
-                        onlyActual.push_back(a);
-                    }
-                }
-
-
-                if ((onlyExpected.size() + both.size()) > 0) {
-                    double sss = onlyExpected.size() + both.size();
-                    double oe = onlyExpected.size() / sss;;
-                    double oa = onlyActual.size() / sss;
-                    double b = both.size() / sss;
-
-                    printf("      TASK:%s-%d\n", key_map.first.str().c_str(), key_map.second);
-                    printf("      Decision OE:"); for (auto& el : onlyExpected) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      Decision OA:"); for (auto& el : onlyActual) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      Decision B:"); for (auto& el : both) printf("%s - ", el.str().c_str()); printf("\n");
-                    printf("      Decision onlyExpected: %f \n", oe);
-                    printf("      Decision onlyActual: %f \n", oa);
-                    printf("      Decision both: %f \n\n", b);
-
-                    ok_onlyExpectedDecision_all_size.push_back(oe);
-                    ok_onlyActualDecision_all_size.push_back(oa);
-                    ok_bothDecision_all_size.push_back(b);
-
-                }
-            }
-
-
-            printf("\n");
+void SimpleBroadcast1Hop::checkRngIsolation(cModule *mod) const
+{
+    // the replay has no radio and no MAC: their draws must not move the streams of the application
+    if (dynamic_cast<SimpleBroadcast1Hop *>(mod) == nullptr) {
+        for (int k = 0; k < std::max(1, mod->getNumRNGs()); k++) {
+            cRNG *rng = mod->getRNG(k);
+            if (rng == getRNG(taskRng) || rng == getRNG(forwardingRng) || rng == getRNG(placementRng))
+                throw cRuntimeError("RNG %d of %s is also used by the application, the replay of the recorded inputs would diverge",
+                        k, mod->getFullPath().c_str());
         }
+    }
+    for (cModule::SubmoduleIterator it(mod); !it.end(); ++it)
+        checkRngIsolation(*it);
+}
 
-        double ok_avg_delay = 0;
-        if (ok_total_task_deployed > 0) {
-            ok_avg_delay = ok_task_deployed_latency_sum / ok_total_task_deployed;
-        }
+void SimpleBroadcast1Hop::fillOracleTable()
+{
+    if (registry == nullptr)
+        throw cRuntimeError("initialTableMode = \"oracle\" needs the OrchestrationRegistry, see registryModule");
+    double range = par("initialTableRange");
+    if (range <= 0)
+        throw cRuntimeError("Invalid initialTableRange parameter");
 
-        double ok_avg_num_hops = 0;
-        if (ok_total_task_deployed > 0) {
-            ok_avg_num_hops = ok_task_deployed_hops_sum / ok_total_task_deployed;
-        }
+    // what the dissemination converges to: PROGRESSIVE nodes only know their neighbours
+    std::vector<OrchestrationRegistry::Route> routes;
+    registry->findRoutes(myAddress, range, dissType == PROGRESSIVE ? 1 : -1, routes);
 
-        double ok_deployed_deployable_atleast1_ratio = 0;
-        if (ok_total_task_generated_deployable > 0) {
-            ok_deployed_deployable_atleast1_ratio = ok_task_deployed_atleast1_if_deployable / ok_total_task_generated_deployable;
-        }
+    const NodeTable& nodes = registry->getNodes();
 
-        double ok_task_deployed_if_deployable_avg = 0;
-        if (ok_total_task_generated_deployable > 0) {
-            ok_task_deployed_if_deployable_avg = ok_task_deployed_sum_if_deployable / ok_total_task_generated_deployable;
+    // a PROGRESSIVE heartbeat folds the sender with the heartbeats it received, so
+    // at convergence every neighbour advertises the fold over the whole component
+    NeighbourAggregates component;
+    if (dissType == PROGRESSIVE) {
+        std::vector<OrchestrationRegistry::Route> componentRoutes;
+        registry->findRoutes(myAddress, range, -1, componentRoutes);
+        for (const auto& route : componentRoutes)
+            component.nodeChanged(nodes, route.slot);
+    }
+
+    nodeTable.reserve(routes.size());
+    for (const auto& route : routes) {
+        if (route.hops == 0)
+            continue; // this node
+        NodeData data = nodes.get(route.slot);
+        if (dissType == PROGRESSIVE) {
+            data.compMaxUsage = component.getMaxCompMaxUsage();
+            data.memoryMaxUsage = component.getMaxMemoryMaxUsage();
+            data.compActUsage = component.getMinCompActUsage();
+            data.memoryActUsage = component.getMinMemoryActUsage();
+            data.hasCamera = component.anyCamera();
+            data.lockedCamera = component.anyCamera() && !component.anyFreeCamera();
+            data.hasGPU = component.anyGPU();
+            data.lockedGPU = component.anyGPU() && !component.anyFreeGPU();
+            data.lockedFly = !component.anyFreeFly();
         }
+        data.timestamp = simTime();
+        data.radius = route.radius;
+        std::fill(data.lastSeqNumber, data.lastSeqNumber + 16, 0);
+        data.nextHop_address = nodes.getAddress(route.nextHopSlot);
+        data.num_hops = route.hops;
+        nodeTable.upsert(data.address, data);
+    }
 
-        double ok_expected_size = 0;
-        double ok_actual_size = 0;
-        double ok_both_size = 0;
-        if (ok_onlyExpected_all_size.size() > 0) {
-            double sum = std::accumulate(ok_onlyExpected_all_size.begin(), ok_onlyExpected_all_size.end(), 0.0);
-            ok_expected_size = sum / ok_onlyExpected_all_size.size();
-        }
-        if (ok_onlyActual_all_size.size() > 0) {
-            double sum = std::accumulate(ok_onlyActual_all_size.begin(), ok_onlyActual_all_size.end(), 0.0);
-            ok_actual_size = sum / ok_onlyActual_all_size.size();
-        }
-        if (ok_both_all_size.size() > 0) {
-            double sum = std::accumulate(ok_both_all_size.begin(), ok_both_all_size.end(), 0.0);
-            ok_both_size = sum / ok_both_all_size.size();
-        }
+    EV_INFO << "Oracle table: " << nodeTable.size() << " nodes within " << range << "m radio range" << endl;
+}
 
+namespace {
 
+// parameters that shape the state up to the end of the warm-up, besides dissType and the resources
+const char *const WARMUP_PARAMS[] = {
+    "startTime", "stopTime", "sendInterval", "messageLength", "localPort", "destPort", "destAddresses",
+    "timeToLive", "initialTableMode", "initialTableRange", "gridCellSize", "relayFilterWindow",
+    "relayFilterExpiry", "deployedTaskExpiry",
+};
 
+} // namespace
 
-        double ok_expectedDecision_size = 0;
-        double ok_actualDecision_size = 0;
-        double ok_bothDecision_size = 0;
-        if (ok_onlyExpectedDecision_all_size.size() > 0) {
-            double sum = std::accumulate(ok_onlyExpectedDecision_all_size.begin(), ok_onlyExpectedDecision_all_size.end(), 0.0);
-            ok_expectedDecision_size = sum / ok_onlyExpectedDecision_all_size.size();
-        }
-        if (ok_onlyActualDecision_all_size.size() > 0) {
-            double sum = std::accumulate(ok_onlyActualDecision_all_size.begin(), ok_onlyActualDecision_all_size.end(), 0.0);
-            ok_actualDecision_size = sum / ok_onlyActualDecision_all_size.size();
-        }
-        if (ok_bothDecision_all_size.size() > 0) {
-            double sum = std::accumulate(ok_bothDecision_all_size.begin(), ok_bothDecision_all_size.end(), 0.0);
-            ok_bothDecision_size = sum / ok_bothDecision_all_size.size();
-        }
+void SimpleBroadcast1Hop::saveSnapshot(SnapshotWriter& w)
+{
+    if (numTaskCreated != 0 || resourceLedger.getNumAdded() != 0 || !forwardingTask_queue.empty() || !ackEntries.empty())
+        throw cRuntimeError("Tasks already exist at t=%gs: the warm-up snapshot must be saved before taskCreationStart", simTime().dbl());
+
+    // warm-up parameters, checked when restoring
+    w.writeAddress(myAddress);
+    w.write<int32_t>(dissType);
+    w.write(computationalPower);
+    w.write(availableMaxMemory);
+    w.write<uint8_t>(hasCamera);
+    w.write<uint8_t>(hasGPU);
+    w.write(getWarmupParamsHash());
+
+    w.write<int32_t>(netPktSent);
+    w.write<int64_t>(netPktSize);
+    w.write<int32_t>(netPktSent_beforeStart);
+    w.write<int64_t>(netPktSize_beforeStart);
+    w.write<int32_t>(numSent);
+    w.write<int32_t>(numReceived);
+    w.write(radius);
+
+    // phase of the heartbeats
+    bool sendScheduled = selfMsg->isScheduled() && selfMsg->getKind() == SEND;
+    w.write<uint8_t>(sendScheduled);
+    w.writeTime(sendScheduled ? selfMsg->getArrivalTime() - simTime() : SIMTIME_ZERO);
+
+    // HIERARCHICAL_CHANGES: what was reported last and what is still to be sent
+    w.write<uint32_t>(lastReport.getSequenceNumber());
+    w.write(lastReport.getCoord_x());
+    w.write(lastReport.getCoord_y());
+    w.write(lastReport.getMemoryActUsage());
+    w.write(lastReport.getMemoryMaxUsage());
+    w.write(lastReport.getCompActUsage());
+    w.write(lastReport.getCompMaxUsage());
+    w.write<uint8_t>(lastReport.getHasCamera());
+    w.write<uint8_t>(lastReport.getLockedCamera());
+    w.write<uint8_t>(lastReport.getHasGPU());
+    w.write<uint8_t>(lastReport.getLockedGPU());
+    w.write<uint8_t>(lastReport.getLockedFly());
+    w.write<uint32_t>(stChanges.size());
+    for (int i = 0; i < stChanges.size(); i++) {
+        const Change& ch = stChanges.at(i);
+        w.write<uint32_t>(ch.getSequenceNumber());
+        w.writeAddress(ch.getIpAddress());
+        w.write<uint8_t>(ch.getParammeter());
+        w.write(ch.getValue());
+        w.write<int32_t>(ch.getHops());
+        w.writeAddress(ch.getNextHop_address());
+    }
+
+    w.write<uint32_t>(nodeTable.size());
+    for (int slot : nodeTable.slotsByAddress())
+        w.writeNodeData(nodeTable.get(slot));
+}
 
-        double ok_num_dep_avg = 0;
-        if (ok_task_deployed_atleast1 > 0) {
-            ok_num_dep_avg = ok_total_task_deployed / ok_task_deployed_atleast1;
+uint64_t SimpleBroadcast1Hop::getWarmupParamsHash()
+{
+    // FNV-1a of "name=value;", volatile parameters by their expression
+    uint64_t h = 1469598103934665603ULL;
+    for (const char *name : WARMUP_PARAMS) {
+        std::string s = std::string(name) + "=" + par(name).str() + ";";
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
         }
+    }
+    return h;
+}
 
-        double ok_deploy_over_deployable_avg = 0;
-        if (ok_task_deployed_if_deployable_avg > 0) {
-            ok_deploy_over_deployable_avg = ok_num_dep_avg / ok_task_deployed_if_deployable_avg;
-        }
+void SimpleBroadcast1Hop::loadSnapshot(SnapshotReader& r, simtime_t warmupTime)
+{
+    L3Address address = r.readAddress();
+    if (address != myAddress)
+        throw cRuntimeError("Warm-up snapshot of %s restored in %s", address.str().c_str(), myAddress.str().c_str());
+    int savedDissType = r.read<int32_t>();
+    double savedComputationalPower = r.read<double>();
+    double savedAvailableMaxMemory = r.read<double>();
+    bool savedHasCamera = r.read<uint8_t>();
+    bool savedHasGPU = r.read<uint8_t>();
+    uint64_t savedParamsHash = r.read<uint64_t>();
+    if (savedDissType != dissType)
+        throw cRuntimeError("dissType=%d differs from the warm-up snapshot (%d)", (int)dissType, savedDissType);
+    if (savedComputationalPower != computationalPower || savedAvailableMaxMemory != availableMaxMemory
+            || savedHasCamera != hasCamera || savedHasGPU != hasGPU)
+        throw cRuntimeError("Node resources differ from the warm-up snapshot");
+    if (savedParamsHash != getWarmupParamsHash()) {
+        std::string names;
+        for (const char *name : WARMUP_PARAMS)
+            names += std::string(names.empty() ? "" : ", ") + name;
+        throw cRuntimeError("Warm-up parameters differ from the warm-up snapshot (one of %s)", names.c_str());
+    }
+
+    netPktSent = r.read<int32_t>();
+    netPktSize = r.read<int64_t>();
+    netPktSent_beforeStart = r.read<int32_t>();
+    netPktSize_beforeStart = r.read<int64_t>();
+    numSent = r.read<int32_t>();
+    numReceived = r.read<int32_t>();
+    radius = r.read<double>();
+
+    // start right away (binding the socket), with the first heartbeat when it was due
+    resumed = r.read<uint8_t>();
+    resumeSendDelay = r.readTime();
+    if (resumed && selfMsg->isScheduled() && selfMsg->getKind() == START) {
+        cancelClockEvent(selfMsg);
+        scheduleClockEventAt(getClockTime(), selfMsg);
+    }
+
+    lastReport.setSequenceNumber(r.read<uint32_t>());
+    lastReport.setCoord_x(r.read<double>());
+    lastReport.setCoord_y(r.read<double>());
+    lastReport.setMemoryActUsage(r.read<double>());
+    lastReport.setMemoryMaxUsage(r.read<double>());
+    lastReport.setCompActUsage(r.read<double>());
+    lastReport.setCompMaxUsage(r.read<double>());
+    lastReport.setHasCamera(r.read<uint8_t>());
+    lastReport.setLockedCamera(r.read<uint8_t>());
+    lastReport.setHasGPU(r.read<uint8_t>());
+    lastReport.setLockedGPU(r.read<uint8_t>());
+    lastReport.setLockedFly(r.read<uint8_t>());
+    uint32_t numChanges = r.read<uint32_t>();
+    for (uint32_t i = 0; i < numChanges; i++) {
+        Change ch;
+        ch.setSequenceNumber(r.read<uint32_t>());
+        ch.setIpAddress(r.readAddress());
+        ch.setParammeter(r.read<uint8_t>());
+        ch.setValue(r.read<double>());
+        ch.setHops(r.read<int32_t>());
+        ch.setNextHop_address(r.readAddress());
+        stChanges.push(ch);
+    }
+
+    uint32_t numNodes = r.read<uint32_t>();
+    nodeTable.reserve(numNodes);
+    for (uint32_t i = 0; i < numNodes; i++) {
+        NodeData data = r.readNodeData();
+        data.timestamp -= warmupTime;
+        nodeTable.upsert(data.address, data);
+    }
+    EV_INFO << "Restored " << numNodes << " nodes from the warm-up snapshot" << endl;
+}
 
-        // #################
-
-        recordScalar("OK - Total Info-layer packets sent", sumNetPktSent);
-        recordScalar("OK - Total Info-layer traffic size", sumNetPktSize);
-        recordScalar("OK - Total Info-layer packets sent per second", sumNetPktSent / (simTime() - startMakingStats));
-        recordScalar("OK - Total Info-layer traffic size per second", sumNetPktSize / (simTime() - startMakingStats));
-        recordScalar("OK - task deployed time avg", ok_avg_delay);
-        recordScalar("OK - task deployed hops avg", ok_avg_num_hops);
-        recordScalar("OK - task generated number", ok_total_task_generated);
-        recordScalar("OK - task deployable generated number", ok_total_task_generated_deployable);
-        recordScalar("OK - task total deployment number", ok_total_task_deployed);
-        recordScalar("OK - task total deployment at least 1 number", ok_task_deployed_atleast1);
-        recordScalar("OK - task deployable total deployment at least 1 number", ok_task_deployed_atleast1_if_deployable);
-        recordScalar("OK - task deployable total deployment at least 1 number - Ratio", ok_deployed_deployable_atleast1_ratio);
-        recordScalar("OK - task deployable total deployment number for each task - AVG", ok_task_deployed_if_deployable_avg);
-        recordScalar("OK - task deployment number for each task - AVG", ok_num_dep_avg);
-        recordScalar("OK - task deployment number over deployable for each task - AVG", ok_deploy_over_deployable_avg);
-
-        recordScalar("OK - expected only deployment size total", ok_expected_size);
-        recordScalar("OK - actual only deployment size total", ok_actual_size);
-        recordScalar("OK - expected and actual deployment size total", ok_both_size);
-
-        recordScalar("OK - expected Decision only deployment size total", ok_expectedDecision_size);
-        recordScalar("OK - actual Decision only deployment size total", ok_actualDecision_size);
-        recordScalar("OK - expected and actual Decision deployment size total", ok_bothDecision_size);
+void SimpleBroadcast1Hop::finish()
+{
+    recordScalar("packets sent", numSent);
+    recordScalar("packets received", numReceived);
+    recordScalar("Info-layer packets sent", netPktSent);
+    recordScalar("Info-layer traffic size", netPktSize);
+    recordScalar("decision cache hits", decisionCache.getNumHits());
+    recordScalar("decision cache updates", decisionCache.getNumUpdates());
+    recordScalar("decision cache misses", decisionCache.getNumMisses());
+    recordScalar("relay filter queries", relayFilter.getNumQueries());
+    recordScalar("relay filter below-window rate (FP upper bound)", relayFilter.getBelowWindowRate());
+    recordScalar("relay filter memory", relayFilter.getMemoryBytes());
+    dumpTrace("finish");
+    if (inputLog.isOpen()) {
+        EV_INFO << inputLog.getNumRecords() << " inputs recorded" << endl;
+        inputLog.close();
     }
 
+    // the network-wide task statistics are recorded by DeploymentStatistics
+
     ApplicationBase::finish();
 }
 
@@ -721,7 +510,7 @@ void SimpleBroadcast1Hop::setSocketOptions()
 
 L3Address SimpleBroadcast1Hop::chooseDestAddr()
 {
-    int k = intrand(destAddresses.size());
+    int k = intrand(destAddresses.size(), forwardingRng);
     if (destAddresses[k].isUnspecified() || destAddresses[k].isLinkLocal()) {
         L3AddressResolver().tryResolve(destAddressStr[k].c_str(), destAddresses[k]);
     }
@@ -729,18 +518,66 @@ L3Address SimpleBroadcast1Hop::chooseDestAddr()
 }
 
 void SimpleBroadcast1Hop::updateRadius(){
-    double x1 = mob->getCurrentPosition().x;
-    double y1 = mob->getCurrentPosition().y;
-    radius = 0;
-    for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap.begin(); it != nodeDataMap.end(); ++it) {
-        L3Address ipAddr = it->first;
-        NodeData data = it->second;
-        //calculate new radius - if granter than previous, overwrite it
-        double r = sqrt((x1-data.coord_x)*(x1-data.coord_x) + (y1-data.coord_y)*(y1-data.coord_y));
-        if (r > radius) radius = r;
+    // only PROGRESSIVE heartbeats carry it, and only then is neighbourAggregates fed by nodeTable
+    radius = neighbourAggregates.getRadius(mob->getCurrentPosition().x, mob->getCurrentPosition().y);
+}
+
+namespace {
+
+bool sameLoad(const LoadStep& a, const LoadStep& b)
+{
+    return a.compActUsage == b.compActUsage && a.memoryActUsage == b.memoryActUsage
+            && a.lockedGPU == b.lockedGPU && a.lockedCamera == b.lockedCamera && a.lockedFly == b.lockedFly;
+}
+
+/** Removes the steps that do not change the load of the previous one (of current for the first). */
+void dropUnchangedSteps(const LoadStep& current, std::vector<LoadStep>& steps)
+{
+    const LoadStep *previous = &current;
+    size_t n = 0;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (sameLoad(steps[i], *previous))
+            continue;
+        steps[n++] = steps[i];
+        previous = &steps[n - 1];
+    }
+    steps.resize(n);
+}
+
+/** Advertises usage steps as the free capacity left by them under the given maxima. */
+template<typename Msg>
+void writeCapacityTimeline(Msg& msg, const std::vector<LoadStep>& steps, double compMax, double memoryMax)
+{
+    msg.setCapacityTimelineArraySize(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i) {
+        CapacityStep& step = msg.getCapacityTimelineForUpdate(i);
+        step.setTime(steps[i].time);
+        step.setFreeCPU(compMax - steps[i].compActUsage);
+        step.setFreeMemory(memoryMax - steps[i].memoryActUsage);
+        step.setLockedGPU(steps[i].lockedGPU);
+        step.setLockedCamera(steps[i].lockedCamera);
+        step.setLockedFly(steps[i].lockedFly);
     }
 }
 
+/** Inverse of writeCapacityTimeline(). */
+template<typename Msg>
+void readCapacityTimeline(const Msg& msg, double compMax, double memoryMax, std::vector<LoadStep>& out)
+{
+    out.resize(msg.getCapacityTimelineArraySize());
+    for (size_t i = 0; i < out.size(); ++i) {
+        const CapacityStep& step = msg.getCapacityTimeline(i);
+        out[i].time = step.getTime();
+        out[i].compActUsage = compMax - step.getFreeCPU();
+        out[i].memoryActUsage = memoryMax - step.getFreeMemory();
+        out[i].lockedGPU = step.getLockedGPU();
+        out[i].lockedCamera = step.getLockedCamera();
+        out[i].lockedFly = step.getLockedFly();
+    }
+}
+
+} // namespace
+
 Ptr<Heartbeat> SimpleBroadcast1Hop::createPayload()
 {
     const auto& payload = makeShared<Heartbeat>();
@@ -754,98 +591,73 @@ Ptr<Heartbeat> SimpleBroadcast1Hop::createPayload()
 
 
     //update self use by assigned tasks
-    double compActUsage = 0;
-    double memActUsage = 0;
-    bool lockedGPU = false;
-    bool lockedCamera = false;
-    bool lockedFly = false;
-    for (size_t i = 0; i < assignedTask_list.size(); ++i) {
-        if ((simTime() < assignedTask_list[i].getEnd_timestamp()) && (simTime() >= assignedTask_list[i].getStart_timestamp())){
-            compActUsage += assignedTask_list[i].getReqCPU();
-            memActUsage += assignedTask_list[i].getReqMemory();
-            if (assignedTask_list[i].getLockGPU()) lockedGPU = true;
-            if (assignedTask_list[i].getLockCamera()) lockedCamera = true;
-            if (assignedTask_list[i].getReq_lock_flyengine()) lockedFly = true;
-        }
-    }
+    resourceLedger.advance(simTime());
+    LoadStep current;
+    current.compActUsage = resourceLedger.getCompUsage();
+    current.memoryActUsage = resourceLedger.getMemoryUsage();
+    current.lockedGPU = resourceLedger.isGPULocked();
+    current.lockedCamera = resourceLedger.isCameraLocked();
+    current.lockedFly = resourceLedger.isFlyLocked();
+    getMyTimeline(timelineSteps);
 
     payload->setCompMaxUsage(computationalPower);
     payload->setMemoryMaxUsage(availableMaxMemory);
 
-    payload->setCompActUsage(compActUsage);
-    payload->setMemoryActUsage(memActUsage);
-
     payload->setHasCamera(hasCamera);
     payload->setHasGPU(hasGPU);
 
-    payload->setLockedCamera(lockedCamera);
-    payload->setLockedFly(lockedFly);
-    payload->setLockedGPU(lockedGPU);
-
-
     if (dissType == PROGRESSIVE) {
         //in Aggregated knowledge, I will send only 1-hop nodes
         //choose the best metrics between me and my 1-hop neighbors and broadcast it
         updateRadius();
         payload->setRadius(radius);
 
-        for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap.begin(); it != nodeDataMap.end(); ++it) {
-            L3Address ipAddr = it->first;
-            NodeData data = it->second;
-
-            // I need to overwrite the metrics based on best choices
-
-            //rule for CompMaxUsage
-            if (data.compMaxUsage > payload->getCompMaxUsage())
-                payload->setCompMaxUsage(data.memoryMaxUsage);
-
-            //rule for MemoryMaxUsage
-            if (data.memoryMaxUsage > payload->getMemoryMaxUsage())
-                payload->setMemoryMaxUsage(data.memoryMaxUsage);
-
-            //rule for CompActUsage - choose the minor
-            if (data.compActUsage < payload->getCompActUsage())
-                payload->setCompActUsage(data.compActUsage);
-
-            //rule for MemoryActUsage - choose the minor
-            if (data.memoryActUsage < payload->getMemoryActUsage())
-                payload->setMemoryActUsage(data.memoryActUsage);
+        // I need to overwrite the metrics based on best choices
+        if (!neighbourAggregates.empty()) {
+            //rule for CompMaxUsage and MemoryMaxUsage - choose the major
+            payload->setCompMaxUsage(std::max(computationalPower, neighbourAggregates.getMaxCompMaxUsage()));
+            payload->setMemoryMaxUsage(std::max(availableMaxMemory, neighbourAggregates.getMaxMemoryMaxUsage()));
+
+            //rule for HasCamera and HasGPU - any of them
+            payload->setHasCamera(hasCamera || neighbourAggregates.anyCamera());
+            payload->setHasGPU(hasGPU || neighbourAggregates.anyGPU());
+
+            //usage and locks, now and at each step of my timeline
+            current = foldNeighbourAggregates(current);
+            for (LoadStep& step : timelineSteps)
+                step = foldNeighbourAggregates(step);
+            dropUnchangedSteps(current, timelineSteps);
+        }
+    }
 
-            //rule for HasCamera and LockedCamera
-            payload->setHasCamera(payload->getHasCamera() || data.hasCamera);
-            payload->setLockedCamera(!payload->getHasCamera()&&data.lockedCamera ||
-                                    payload->getLockedCamera()&&!data.hasCamera ||
-                                    payload->getLockedCamera()&&data.lockedCamera);
+    payload->setCompActUsage(current.compActUsage);
+    payload->setMemoryActUsage(current.memoryActUsage);
 
+    payload->setLockedCamera(current.lockedCamera);
+    payload->setLockedFly(current.lockedFly);
+    payload->setLockedGPU(current.lockedGPU);
 
-            //rule for HasGPU and LockedGPU
-            payload->setHasGPU(payload->getHasGPU() || data.hasGPU);
-            payload->setLockedGPU(!payload->getHasGPU()&&data.lockedGPU ||
-                                    payload->getLockedGPU()&&!data.hasGPU ||
-                                    payload->getLockedGPU()&&data.lockedGPU);
+    writeCapacityTimeline(*payload, timelineSteps, payload->getCompMaxUsage(), payload->getMemoryMaxUsage());
 
-            //rule for LockedFly
-            payload->setLockedFly((lockedFly && data.lockedFly));
-        }
-
-        uint32_t s = sizeof(Heartbeat);
+    if (dissType == PROGRESSIVE) {
+        uint32_t s = sizeof(Heartbeat) + timelineSteps.size() * sizeof(CapacityStep);
 
         //printf("sizeof(Heartbeat): %d; SUM: %d \n", sizeof(Heartbeat), s);fflush(stdout);
 
-        netPktSize += s;
-        if (simTime() <= startMakingStats) netPktSize_beforeStart += s;
+        countInfoPacket(s);
 
 
     } else {
         //sending full node table data
         int i = 0;
+        size_t numSteps = timelineSteps.size();
 
-        payload->setNodeInfoListArraySize(nodeDataMap.size());
-        for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap.begin(); it != nodeDataMap.end(); ++it) {
-            L3Address ipAddr = it->first;
-            NodeData data = it->second;
+        payload->setNodeInfoListArraySize(nodeTable.size());
+        for (int slot : nodeTable.slotsByAddress()) {
+            NodeData data = nodeTable.get(slot);
 
-            NodeInfo new_NodeInfo;
+            // filled in place, the array was sized above
+            NodeInfo& new_NodeInfo = payload->getNodeInfoListForUpdate(i);
             new_NodeInfo.setTimestamp(data.timestamp);
             new_NodeInfo.setSequenceNumber(data.sequenceNumber);
             new_NodeInfo.setIpAddress(data.address);
@@ -856,35 +668,27 @@ Ptr<Heartbeat> SimpleBroadcast1Hop::createPayload()
             new_NodeInfo.setCompActUsage(data.compActUsage);
             new_NodeInfo.setCompMaxUsage(data.compMaxUsage);
 
-            new_NodeInfo.setNextHop_address(data.nextHop_address);
-            new_NodeInfo.setNum_hops(data.num_hops);
             new_NodeInfo.setNextHop_address(data.nextHop_address);
             new_NodeInfo.setNum_hops(data.num_hops);
 
-            new_NodeInfo.setHasGPU(data.hasGPU);
-            new_NodeInfo.setHasCamera(data.hasCamera);
             new_NodeInfo.setHasGPU(data.hasGPU);
             new_NodeInfo.setHasCamera(data.hasCamera);
 
-            new_NodeInfo.setLockedCamera(data.lockedCamera);
-            new_NodeInfo.setLockedGPU(data.lockedGPU);
-            new_NodeInfo.setLockedFly(data.lockedFly);
             new_NodeInfo.setLockedCamera(data.lockedCamera);
             new_NodeInfo.setLockedGPU(data.lockedGPU);
             new_NodeInfo.setLockedFly(data.lockedFly);
 
-            payload->setNodeInfoList(i, new_NodeInfo);
-            payload->setNodeInfoList(i, new_NodeInfo);
+            writeCapacityTimeline(new_NodeInfo, data.timeline, data.compMaxUsage, data.memoryMaxUsage);
+            numSteps += data.timeline.size();
 
             i++;
         }
-        uint32_t s = sizeof(Heartbeat) + i * sizeof(NodeInfo) ;
+        uint32_t s = sizeof(Heartbeat) + i * sizeof(NodeInfo) + numSteps * sizeof(CapacityStep);
 
         //printf("sizeof(Heartbeat): %d; sizeof(NodeInfo): %d; i: %d, SUM: %d \n",
         //            sizeof(Heartbeat), sizeof(NodeInfo), i, s);fflush(stdout);
 
-        netPktSize += s;
-        if (simTime() <= startMakingStats) netPktSize_beforeStart += s;
+        countInfoPacket(s);
 
     }
     payload->addTag<CreationTimeTag>()->setCreationTime(simTime());
@@ -892,31 +696,38 @@ Ptr<Heartbeat> SimpleBroadcast1Hop::createPayload()
     return payload;
 }
 
-void SimpleBroadcast1Hop::sendPacket()
+void SimpleBroadcast1Hop::countInfoPacket(uint32_t size)
 {
-    std::ostringstream str;
+    netPktSize += size;
+    if (simTime() <= startMakingStats)
+        netPktSize_beforeStart += size;
+    else
+        emit(infoPacketSentSignal, (long)size);
+}
 
+void SimpleBroadcast1Hop::sendPacket()
+{
     if (dissType == HIERARCHICAL_CHANGES) {
-        str << "Changes" << "-" << netPktSent; //
-        Packet *packet = new Packet(str.str().c_str());
+        Packet *packet = new Packet("Changes");
         if (dontFragment)
             packet->addTag<FragmentationReq>()->setDontFragment(true);
         const auto& payload = createChangesPayload();
         packet->insertAtBack(payload);
         L3Address destAddr = chooseDestAddr();
+        trace(TRACE_CHANGES_SENT, traceId(destAddr), payload->getChangesCount());
         emit(packetSentSignal, packet);
-        socket.sendTo(packet, destAddr, destPort);
+        sendToSocket(packet, destAddr);
 
     } else {
-        str << packetName << "-" << netPktSent; //
-        Packet *packet = new Packet(str.str().c_str());
+        Packet *packet = new Packet(packetName);
         if (dontFragment)
             packet->addTag<FragmentationReq>()->setDontFragment(true);
         const auto& payload = createPayload();
         packet->insertAtBack(payload);
         L3Address destAddr = chooseDestAddr();
+        trace(TRACE_HEARTBEAT_SENT, traceId(destAddr), payload->getSequenceNumber());
         emit(packetSentSignal, packet);
-        socket.sendTo(packet, destAddr, destPort);
+        sendToSocket(packet, destAddr);
 
     }
     numSent++;
@@ -975,10 +786,12 @@ void SimpleBroadcast1Hop::sendPacket()
 
 void SimpleBroadcast1Hop::processStart()
 {
-    socket.setOutputGate(gate("socketOut"));
-    const char *localAddress = par("localAddress");
-    socket.bind(*localAddress ? L3AddressResolver().resolve(localAddress) : L3Address(), localPort);
-    setSocketOptions();
+    if (!replaying) {
+        socket.setOutputGate(gate("socketOut"));
+        const char *localAddress = par("localAddress");
+        socket.bind(*localAddress ? L3AddressResolver().resolve(localAddress) : L3Address(), localPort);
+        setSocketOptions();
+    }
 
     const char *destAddrs = par("destAddresses");
     cStringTokenizer tokenizer(destAddrs);
@@ -995,7 +808,10 @@ void SimpleBroadcast1Hop::processStart()
 
     if (!destAddresses.empty()) {
         selfMsg->setKind(SEND);
-        processSend();
+        if (resumed)
+            scheduleClockEventAfter(SIMTIME_AS_CLOCKTIME(resumeSendDelay), selfMsg);
+        else
+            processSend();
 
         if (par("taskGeneration").boolValue()){
             taskMsg->setKind(NEW_T);
@@ -1006,10 +822,8 @@ void SimpleBroadcast1Hop::processStart()
         //scheduleClockEventAfter(truncnormal(mean_tf, stddev_tf), taskForwardMsg);
 
 
-        if (ack_func){
-            taskAckMsg->setKind(ACK_CHECK);
-            scheduleClockEventAfter(truncnormal(1, 0.01), taskAckMsg);
-        }
+        // the ACK timer is scheduled at the first pending deadline, see rescheduleAckTimer()
+        taskAckMsg->setKind(ACK_CHECK);
 
     }
     else {
@@ -1036,7 +850,8 @@ void SimpleBroadcast1Hop::processSend()
 
 void SimpleBroadcast1Hop::processStop()
 {
-    socket.close();
+    if (!replaying)
+        socket.close();
 
     if (taskMsg->isScheduled()){
         cancelEvent(taskMsg);
@@ -1048,36 +863,67 @@ void SimpleBroadcast1Hop::ackTask()
     debugPrint("SimpleBroadcast1Hop::ackTask::begin\n");
     simtime_t nowT = simTime();
 
-    for (auto it = ackVector.begin(); it != ackVector.end(); ) {
-        if ((nowT - it->sendingTimestamp).dbl() > ackTimer)
-        {
-            if (forwardingTask_queue.empty()) {
-                scheduleClockEventAfter(uniform(0, maxForwardDelay), taskForwardMsg);
-            }
+    while (!ackDeadlines.empty() && ackDeadlines.top().first <= nowT) {
+        long entryId = ackDeadlines.top().second;
+        ackDeadlines.pop();
 
-            // Enqueue the task to re-send it
-            Forwarding_Task ft;
-            ft.dests = it->non_ack_dests;
-            ft.task = it->ft.task;
-            ft.ttls = it->non_ack_ttls;
-            ft.numberOfSending = 0;
-            forwardingTask_queue.push(ft);
+        auto it = ackEntries.find(entryId);
+        if (it == ackEntries.end())
+            continue; // fully acknowledged in the meantime
 
-            // Remove the element from ackVector; erase returns an iterator
-            // pointing to the next element after the erased one
-            it = ackVector.erase(it);
-
-            EV_INFO << "ACK expired sending TASK again" << endl;
+        Ack_Forwarding_Task& aft = it->second;
+        if (forwardingTask_queue.empty()) {
+            scheduleClockEventAfter(uniform(0, maxForwardDelay, forwardingRng), taskForwardMsg);
         }
-        else
-        {
-            // Only advance if we haven't erased
-            ++it;
+
+        // Enqueue the task to re-send it, compacting the entry vectors to the unacknowledged destinations
+        Forwarding_Task& ft = aft.ft;
+        const TaskREQ& task = *ft.task;
+        size_t kept = 0;
+        for (size_t i = 0; i < ft.dests.size(); ++i) {
+            if (!aft.acked[i]) {
+                // drop the index entry of this destination
+                auto& refs = ackIndex[AckKey{task.getGen_ipAddress(), (uint32_t)task.getId(), ft.dests[i]}];
+                refs.erase(std::remove(refs.begin(), refs.end(), std::make_pair(entryId, (int)i)), refs.end());
+                if (refs.empty())
+                    ackIndex.erase(AckKey{task.getGen_ipAddress(), (uint32_t)task.getId(), ft.dests[i]});
+
+                ft.dests[kept] = ft.dests[i];
+                ft.ttls[kept] = ft.ttls[i];
+                kept++;
+            }
         }
+        ft.dests.resize(kept);
+        ft.ttls.resize(kept);
+        ft.numberOfSending = 0;
+
+        trace(TRACE_ACK_EXPIRED, traceId(task.getGen_ipAddress()), task.getId(), kept);
+        forwardingTask_queue.push(std::move(ft));
+        ackEntries.erase(it);
+
+        EV_INFO << "ACK expired sending TASK again" << endl;
     }
+
+    rescheduleAckTimer();
     debugPrint("SimpleBroadcast1Hop::ackTask::end\n");
 }
 
+void SimpleBroadcast1Hop::rescheduleAckTimer()
+{
+    // skip the deadlines of entries that have been fully acknowledged
+    while (!ackDeadlines.empty() && ackEntries.count(ackDeadlines.top().second) == 0)
+        ackDeadlines.pop();
+
+    if (ackDeadlines.empty()) {
+        cancelClockEvent(taskAckMsg);
+    }
+    else if (!taskAckMsg->isScheduled() || taskAckMsg->getArrivalTime() != ackDeadlines.top().first) {
+        cancelClockEvent(taskAckMsg);
+        taskAckMsg->setKind(ACK_CHECK);
+        scheduleClockEventAfter((ackDeadlines.top().first - simTime()).dbl(), taskAckMsg);
+    }
+}
+
 void SimpleBroadcast1Hop::forwardTask()
 {
     // Dequeue
@@ -1086,20 +932,26 @@ void SimpleBroadcast1Hop::forwardTask()
         Forwarding_Task& frontTask = forwardingTask_queue.front();
 
         // Forward to all destinations
-        sendTaskTo(frontTask.dests, frontTask.task, frontTask.ttls);
-
-        if (ack_func) {
-            if (frontTask.numberOfSending < numberOfMaxRetry) {
-
-                //adding it to the ack list
-                Ack_Forwarding_Task newAFT;
-                newAFT.ft = frontTask;
-                newAFT.ft.numberOfSending += 1;
-                newAFT.non_ack_dests.insert(newAFT.non_ack_dests.begin(), frontTask.dests.begin(), frontTask.dests.end());
-                newAFT.non_ack_ttls.insert(newAFT.non_ack_ttls.begin(), frontTask.ttls.begin(), frontTask.ttls.end());
-                newAFT.sendingTimestamp = simTime();
-                ackVector.push_back(newAFT);
-            }
+        sendTaskTo(frontTask.dests, *frontTask.task, frontTask.ttls);
+
+        if (ack_func && frontTask.numberOfSending < numberOfMaxRetry) {
+            //adding it to the ack list; the entry takes over the queued task and its vectors
+            long entryId = nextAckEntryId++;
+            Ack_Forwarding_Task& newAFT = ackEntries[entryId];
+            newAFT.ft = std::move(frontTask);
+            newAFT.ft.numberOfSending += 1;
+            newAFT.acked.assign(newAFT.ft.dests.size(), false);
+            newAFT.numPending = newAFT.ft.dests.size();
+            newAFT.sendingTimestamp = simTime();
+            const TaskREQ& task = *newAFT.ft.task;
+            for (size_t i = 0; i < newAFT.ft.dests.size(); ++i)
+                ackIndex[AckKey{task.getGen_ipAddress(), (uint32_t)task.getId(), newAFT.ft.dests[i]}].push_back(std::make_pair(entryId, (int)i));
+
+            ackDeadlines.push(std::make_pair(newAFT.sendingTimestamp + ackTimer, entryId));
+            rescheduleAckTimer();
+        }
+        else {
+            releaseForwarding(frontTask);
         }
 
         // Once handled, pop it
@@ -1126,8 +978,8 @@ TaskREQ SimpleBroadcast1Hop::parseTask() // TODO
 
     newTask.setDevType(DEVTYPE_DRONE);
     newTask.setReqPosition(true);
-    newTask.setPos_coord_x(uniform(630, 1900));//(1560);
-    newTask.setPos_coord_y(uniform(630, 1900)); //(1560);
+    newTask.setPos_coord_x(uniform(630, 1900, taskRng));//(1560);
+    newTask.setPos_coord_y(uniform(630, 1900, taskRng)); //(1560);
     newTask.setRange(630);
     newTask.setReqCamera(true);
     newTask.setReqCPU(3);
@@ -1146,185 +998,58 @@ TaskREQ SimpleBroadcast1Hop::parseTask() // TODO
     return newTask;
 }
 
-static bool isInsideCircle(double xCenter, double yCenter, double radius,
-                    double xPoint, double yPoint)
+// Requirements seen by DecisionEngine and CandidateEvaluator
+static TaskRequirements toRequirements(const TaskREQ& task)
 {
-    double dx = xPoint - xCenter;
-    double dy = yPoint - yCenter;
-    double distSquared = dx * dx + dy * dy;
-    double radiusSquared = radius * radius;
-    return (distSquared <= radiusSquared);
-}
-
-
-bool SimpleBroadcast1Hop::isDeployFeasible(TaskREQ& task, NodeData node) {
-    bool ris = true;
-
-    //check coords
-    if (task.getReqPosition() && (!isInsideCircle(task.getPos_coord_x(), task.getPos_coord_y(), task.getRange(), node.coord_x, node.coord_y)))
-        ris = false;
-
-    //check GPU
-    if ((task.getReqCPU() && node.lockedGPU) || (task.getReqCPU() && !node.hasGPU))
-        ris = false;
-
-    //check locked Fly
-    if (task.getReq_lock_flyengine() && node.lockedFly)
-        return false;
-
-    //check camera
-    if ((task.getReqCamera() && node.lockedCamera) || (task.getReqCamera() && !node.hasCamera))
-        ris = false;
-
-    //check CPU
-    if ((task.getReqCPU() + node.compActUsage) > node.compMaxUsage)
-        ris = false;
-
-
-    //check Memory
-    if ((task.getReqMemory() + node.memoryActUsage) > node.memoryMaxUsage)
-        ris = false;
-
-    return ris;
+    TaskRequirements req;
+    req.reqPosition = task.getReqPosition();
+    req.posX = task.getPos_coord_x();
+    req.posY = task.getPos_coord_y();
+    req.range = task.getRange();
+    req.reqLockFly = task.getReq_lock_flyengine();
+    req.reqCamera = task.getReqCamera();
+    req.reqGPU = task.getReqCPU(); // the per-node check gates the GPU test on reqCPU
+    req.reqCPU = task.getReqCPU();
+    req.reqMemory = task.getReqMemory();
+    return req;
 }
 
-static double directionFactor(double xa, double ya,
-                 double xb, double yb,
-                 double xd, double yd,
-                 double alphaDegrees)
+static bool keepsAllDestinations(const TaskREQ& task)
 {
-    // 1) Build vectors AD and AB
-    double ADx = xd - xa;
-    double ADy = yd - ya;
-    double ABx = xb - xa;
-    double ABy = yb - ya;
-
-    // 2) Compute dot product
-    double dot = (ADx * ABx) + (ADy * ABy);
-
-    // 3) Compute magnitudes (watch out for zero length)
-    double magAD = std::sqrt(ADx*ADx + ADy*ADy);
-    double magAB = std::sqrt(ABx*ABx + ABy*ABy);
-
-    // If either vector is zero-length, angle is undefined; handle as needed
-    if (magAD < 1e-9 || magAB < 1e-9) {
-        return false;
-    }
-
-    // 4) Compute angle in radians
-    double cosTheta = dot / (magAD * magAB);
-
-    // Numerical safety: clamp cosTheta to [-1, 1] to avoid domain errors in acos
-    if (cosTheta > 1.0)  cosTheta = 1.0;
-    else if (cosTheta < -1.0) cosTheta = -1.0;
-
-    double thetaRad = std::acos(cosTheta);
-    // Convert to degrees
-    double thetaDeg = thetaRad * 180.0 / M_PI;
-
-    // 5) Compare to alpha
-    //return (thetaDeg <= alphaDegrees);
-
-    // Now compute piecewise-linear factor:
-    // f(theta) = 1 - (theta / alpha), clipped to [0, 1].
-    if (thetaDeg <= 0.0) {
-        return 1.0; // the vectors are basically identical direction
-    } else if (thetaDeg >= alphaDegrees) {
-        return 0.0; // angle is outside arc
-    } else {
-        return 1.0 - (thetaDeg / alphaDegrees);
-    }
+    return (task.getStrategy() == STRATEGY_FORALL) || (task.getStrategy() == STRATEGY_MANY);
 }
-//
-//int main()
-//{
-//    double xa = 0, ya = 0;
-//    double xb = 1, yb = 1;
-//    double xd = 2, yd = 0;
-//    double alpha = 45.0;  // degrees
-//
-//    bool result = isWithinArc(xa, ya, xb, yb, xd, yd, alpha);
-//    std::cout << "B is "
-//              << (result ? "" : "not ")
-//              << "within " << alpha << " degrees of A->D\n";
-//    return 0;
-//}
-
-
-double SimpleBroadcast1Hop::calculateProgressiveScore(TaskREQ& task, NodeData node) {
-    double ris = 0;
-    double pos_fact = 1;
-    double gpu_fact = 1;
-    double mem_fact = 1;
-    double cpu_fact = 1;
-    double fly_fact = 1;
-    double cam_fact = 1;
-
-    //check coords
-    if (task.getReqPosition()){
-        pos_fact = directionFactor(mob->getCurrentPosition().x, mob->getCurrentPosition().y, node.coord_x, node.coord_y, task.getPos_coord_x(), task.getPos_coord_y(), 90);
-    }
-
-    //check GPU
-    if (task.getReqCPU()) {
-        if (node.lockedGPU || !node.hasGPU) {
-            gpu_fact = 0;
-        }
-    }
-
-    //check locked Fly
-    if (task.getReq_lock_flyengine() && node.lockedFly)
-        fly_fact = 0;
-
-    //check camera
-    if ((task.getReqCamera() && node.lockedCamera) || (task.getReqCamera() && !node.hasCamera))
-        cam_fact = 0;
-
-    //check CPU
 
-    if ((task.getReqCPU() + node.compActUsage) > node.compMaxUsage)
-        cpu_fact = node.compMaxUsage / (task.getReqCPU() + node.compActUsage);
-
-
-    //check Memory
-    if ((task.getReqMemory() + node.memoryActUsage) > node.memoryMaxUsage)
-        mem_fact = node.memoryMaxUsage / (task.getReqMemory() + node.memoryActUsage);
+bool SimpleBroadcast1Hop::isDeployFeasible(const TaskREQ& task, const NodeData& node) {
+    return DecisionEngine::isDeployFeasible(toRequirements(task), toCandidateNode(node));
+}
 
-    return (0.5 * pos_fact) + (0.5 * ((gpu_fact + fly_fact + cam_fact + cpu_fact + mem_fact) / 5.0));
+double SimpleBroadcast1Hop::calculateProgressiveScore(const TaskREQ& task, const NodeData& node) {
+    return DecisionEngine::progressiveScore(toRequirements(task), toCandidateNode(node),
+            mob->getCurrentPosition().x, mob->getCurrentPosition().y, placementPolicy.alphaDegrees);
 }
 
-std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong_Progressive(TaskREQ& task, std::map<L3Address, NodeData>& nodes)
+std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong_Progressive(const TaskREQ& task, const std::vector<std::pair<L3Address, double>>& candidates)
 {
     std::vector<L3Address> ris;
-    std::map<L3Address, double> nodeDataMap_score;
+    std::vector<std::pair<L3Address, double>> nodeDataMap_score;
 
-    //create score map
-    for (std::map<inet::L3Address, NodeData>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-        double score = calculateProgressiveScore(task, it->second);
-        //gamma -> between almost_all and at_least_one
-        //
-        // STRATEGY_FORALL => gamma=almost_all
-        //
+    //create score map: gamma -> between almost_all (FORALL, MANY) and at_least_one
+    double gamma = DecisionEngine::gamma(placementPolicy, keepsAllDestinations(task));
+    for (auto& candidate : candidates)
+        nodeDataMap_score.push_back(std::make_pair(candidate.first, candidate.second / gamma));
 
-        double gamma = ((task.getStrategy() == STRATEGY_FORALL) || (task.getStrategy() == STRATEGY_MANY) ?
-                par("gamma_almost_all") : par("gamma_at_least_one") );
-        // min(1, gamma - score)
-        //score = ((gamma - score) < 1 ? (gamma - score) : 1);
-        //if (score >= 1)
-        //    nodeDataMap_score[it->first] = score;
-        nodeDataMap_score[it->first] = score / gamma;
-    }
-
-    EV_INFO << "checkDeployDestinationAmong_Progressive - Calculated SCORES: " << endl;
-    for (std::map<inet::L3Address, double>::iterator it = nodeDataMap_score.begin(); it != nodeDataMap_score.end(); ++it) {
-        EV_INFO << it->first << " with score " << it->second << endl;
+    if (BW_LOG_DETAIL) {
+        EV_INFO << "checkDeployDestinationAmong_Progressive - Calculated SCORES: " << endl;
+        for (auto it = nodeDataMap_score.begin(); it != nodeDataMap_score.end(); ++it) {
+            EV_INFO << it->first << " with score " << it->second << endl;
+        }
     }
 
     size_t mapSize = nodeDataMap_score.size();
 
     if (mapSize != 0){
 //        if ((task.getStrategy() == STRATEGY_FORALL) || (task.getStrategy() == STRATEGY_MANY)) {
-            for (std::map<inet::L3Address, double>::iterator it = nodeDataMap_score.begin(); it != nodeDataMap_score.end(); ++it) {
+            for (auto it = nodeDataMap_score.begin(); it != nodeDataMap_score.end(); ++it) {
                 ris.push_back(it->first);
             }
 //        }
@@ -1346,18 +1071,11 @@ std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong_Progress
     return ris;
 }
 
-std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong(TaskREQ& task, std::map<L3Address, NodeData>& nodes)
+std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong(const TaskREQ& task, const std::vector<L3Address>& nodeDataMap_feasible)
 {
     std::vector<L3Address> ris;
     //if (dissType == PROGRESSIVE) return ris;
 
-    std::map<L3Address, NodeData> nodeDataMap_feasible;
-    //for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap.begin(); it != nodeDataMap.end(); ++it) {
-    for (std::map<inet::L3Address, NodeData>::iterator it = nodes.begin(); it != nodes.end(); ++it) {
-        if (isDeployFeasible(task, it->second))
-            nodeDataMap_feasible[it->first] = it->second;
-    }
-
     size_t mapSize = nodeDataMap_feasible.size();
 
 //    if (mapSize == 0){
@@ -1373,23 +1091,12 @@ std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong(TaskREQ&
 //        return it->first;
 //    }
 
-    if (mapSize != 0){
-        if ((task.getStrategy() == STRATEGY_FORALL) || (task.getStrategy() == STRATEGY_MANY)) {
-            for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap_feasible.begin(); it != nodeDataMap_feasible.end(); ++it) {
-                ris.push_back(it->first);
-            }
-        }
-        else {
-            //choose randomly
-            int randomIndex = intuniform(0, mapSize - 1);
-            auto it = nodeDataMap_feasible.begin();
-            std::advance(it, randomIndex);
-            EV_INFO << "Deploying TASK to: " << it->first << endl;
-            //return it->first;
-            ris.push_back(it->first);
-        }
-
-    }
+    //choose randomly, unless all the feasible nodes are kept
+    bool keepAll = keepsAllDestinations(task);
+    DecisionEngine::selectAmong(nodeDataMap_feasible, keepAll,
+            [this](int n) { return (int)intuniform(0, n - 1, placementRng); }, ris);
+    if (!keepAll && (mapSize != 0))
+        EV_INFO << "Deploying TASK to: " << ris.front() << endl;
 
     return ris;
 }
@@ -1397,20 +1104,12 @@ std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestinationAmong(TaskREQ&
 SimpleBroadcast1Hop::NodeData SimpleBroadcast1Hop::getMyNodeData(){
     NodeData mydata;
 
-    double compActUsage = 0;
-    double memActUsage = 0;
-    bool lockedGPU = false;
-    bool lockedCamera = false;
-    bool lockedFly = false;
-    for (size_t i = 0; i < assignedTask_list.size(); ++i) {
-        if ((simTime() < assignedTask_list[i].getEnd_timestamp()) && (simTime() >= assignedTask_list[i].getStart_timestamp())){
-            compActUsage += assignedTask_list[i].getReqCPU();
-            memActUsage += assignedTask_list[i].getReqMemory();
-            if (assignedTask_list[i].getLockGPU()) lockedGPU = true;
-            if (assignedTask_list[i].getLockCamera()) lockedCamera = true;
-            if (assignedTask_list[i].getReq_lock_flyengine()) lockedFly = true;
-        }
-    }
+    resourceLedger.advance(simTime());
+    double compActUsage = resourceLedger.getCompUsage();
+    double memActUsage = resourceLedger.getMemoryUsage();
+    bool lockedGPU = resourceLedger.isGPULocked();
+    bool lockedCamera = resourceLedger.isCameraLocked();
+    bool lockedFly = resourceLedger.isFlyLocked();
 
     mydata.timestamp = simTime();
     mydata.sequenceNumber = netPktSent;
@@ -1432,27 +1131,88 @@ SimpleBroadcast1Hop::NodeData SimpleBroadcast1Hop::getMyNodeData(){
     return mydata;
 }
 
-std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestination(TaskREQ& task, L3Address avoidAddress)
+std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestination(const TaskREQ& task, L3Address avoidAddress)
 {
 
-    std::map<L3Address, NodeData> nodeDataMap_all;
-    NodeData mydata = getMyNodeData();
+    // this node and the nodes that advertised a timeline are evaluated on every call, with
+    // their peak usage over the task lifetime; the cache only holds the other nodes
+    simtime_t start = std::max(task.getStart_timestamp(), simTime());
+    simtime_t end = task.getEnd_timestamp();
+    decisionTable.clear();
+    decisionTable.upsert(myAddress, getMyNodeDataFor(task));
+    for (int slot : nodeTable.scheduledSlots()) {
+        const L3Address& addr = nodeTable.getAddress(slot);
+        if (addr == avoidAddress)
+            continue;
+        NodeData data = nodeTable.get(slot);
+        nodeTable.applyPeakLoad(slot, start, end, data);
+        data.timeline.clear();
+        decisionTable.upsert(addr, data);
+    }
+    const std::vector<int>& rows = decisionTable.slotsByAddress();
+
+    // the cache is keyed on the resource requirements; the position terms are applied here
+    TaskRequirements req = toRequirements(task);
+    DecisionKey key(req, dissType == PROGRESSIVE);
+    const DecisionCache::Entry& decision = decisionCache.lookup(nodeTable, key);
+
+    // merge the rows of decisionTable into the cached candidates, keeping the address order
+    size_t next = 0;
+    if (key.progressive) {
+        double originX = mob->getCurrentPosition().x;
+        double originY = mob->getCurrentPosition().y;
+        CandidateEvaluator::evaluateProgressiveScores(req, decisionTable.columns(),
+                originX, originY, placementPolicy.alphaDegrees, candidateScores);
+        CandidateEvaluator::combineProgressiveScores(req, nodeTable.columns(),
+                originX, originY, placementPolicy.alphaDegrees, decision.candidates, decision.scores, slotScores);
+
+        std::vector<std::pair<L3Address, double>> candidates;
+        candidates.reserve(decision.candidates.size() + rows.size());
+        for (int slot : decision.candidates) {
+            const L3Address& addr = nodeTable.getAddress(slot);
+            if (addr == avoidAddress || nodeTable.isScheduled(slot))
+                continue;
+            for (; next < rows.size() && decisionTable.getAddress(rows[next]) < addr; ++next)
+                candidates.push_back(std::make_pair(decisionTable.getAddress(rows[next]), candidateScores[rows[next]]));
+            candidates.push_back(std::make_pair(addr, slotScores[slot]));
+        }
+        for (; next < rows.size(); ++next)
+            candidates.push_back(std::make_pair(decisionTable.getAddress(rows[next]), candidateScores[rows[next]]));
 
-    nodeDataMap_all[myAddress] = mydata;
-    for (std::map<inet::L3Address, NodeData>::iterator it = nodeDataMap.begin(); it != nodeDataMap.end(); ++it) {
-        if (it->first != avoidAddress)
-            nodeDataMap_all[it->first] = it->second;
+        return checkDeployDestinationAmong_Progressive(task, candidates);
     }
+    else {
+        CandidateEvaluator::evaluateFeasibility(req, decisionTable.columns(), feasibleMask);
 
-    EV_INFO << "SimpleBroadcast1Hop::checkDeployDestination. ALL DEVICES" << endl;
-    for (auto& el : nodeDataMap_all) {
-        EV_INFO << el.first << " | " << el.second << endl;
-    }
+        const std::vector<int> *feasible = &decision.candidates;
+        if (req.reqPosition) {
+            decisionCache.selectInCircle(nodeTable, decision, req.posX, req.posY, req.range, slotsInCircle);
+            feasible = &slotsInCircle;
+        }
 
-    if (dissType == PROGRESSIVE)
-        return checkDeployDestinationAmong_Progressive(task, nodeDataMap_all);
-    else
-        return checkDeployDestinationAmong(task, nodeDataMap_all);
+        std::vector<L3Address> candidates;
+        candidates.reserve(feasible->size() + rows.size());
+        for (int slot : *feasible) {
+            const L3Address& addr = nodeTable.getAddress(slot);
+            if (addr == avoidAddress || nodeTable.isScheduled(slot))
+                continue;
+            for (; next < rows.size() && decisionTable.getAddress(rows[next]) < addr; ++next)
+                if (CandidateEvaluator::isFeasible(feasibleMask, rows[next]))
+                    candidates.push_back(decisionTable.getAddress(rows[next]));
+            candidates.push_back(addr);
+        }
+        for (; next < rows.size(); ++next)
+            if (CandidateEvaluator::isFeasible(feasibleMask, rows[next]))
+                candidates.push_back(decisionTable.getAddress(rows[next]));
+
+        if (BW_LOG_DETAIL) {
+            EV_INFO << "SimpleBroadcast1Hop::checkDeployDestination. FEASIBLE DEVICES" << endl;
+            for (auto& addr : candidates)
+                EV_INFO << addr << endl;
+        }
+
+        return checkDeployDestinationAmong(task, candidates);
+    }
 
 //    size_t mapSize = nodeDataMap.size();
 //    double r = uniform(0, 1);
@@ -1472,7 +1232,7 @@ std::vector<L3Address> SimpleBroadcast1Hop::checkDeployDestination(TaskREQ& task
 }
 
 
-Ptr<TaskREQmessage> SimpleBroadcast1Hop::createPayloadForTask(std::vector<std::tuple<L3Address, L3Address, int>>& finaldest_next_ttl, TaskREQ& task)
+Ptr<TaskREQmessage> SimpleBroadcast1Hop::createPayloadForTask(const std::vector<std::tuple<L3Address, L3Address, int>>& finaldest_next_ttl, const TaskREQ& task)
 {
     const auto& payload = makeShared<TaskREQmessage>();
 
@@ -1491,13 +1251,11 @@ Ptr<TaskREQmessage> SimpleBroadcast1Hop::createPayloadForTask(std::vector<std::t
 
 
     payload->setDestDetailArraySize(finaldest_next_ttl.size());
-    for (int i = 0; i < finaldest_next_ttl.size(); ++i) {
-        DestDetail destDetail;
+    for (size_t i = 0; i < finaldest_next_ttl.size(); ++i) {
+        DestDetail& destDetail = payload->getDestDetailForUpdate(i);
         destDetail.setDest_ipAddress(std::get<0>(finaldest_next_ttl[i]));
         destDetail.setNextHop_ipAddress(std::get<1>(finaldest_next_ttl[i]));
         destDetail.setTtl(std::get<2>(finaldest_next_ttl[i]));
-
-        payload->setDestDetail(i, destDetail);
     }
 
 //    payload->setDest_ipAddress(finaldest);
@@ -1509,15 +1267,15 @@ Ptr<TaskREQmessage> SimpleBroadcast1Hop::createPayloadForTask(std::vector<std::t
     return payload;
 }
 
-void SimpleBroadcast1Hop::sendTaskTo(std::vector<L3Address>& dest, TaskREQ& task, std::vector<int>& ttl)
+void SimpleBroadcast1Hop::sendTaskTo(const std::vector<L3Address>& dest, const TaskREQ& task, const std::vector<int>& ttl)
 {
-    std::vector<std::tuple<L3Address, L3Address, int>> dest_next_ttl;
+    std::vector<std::tuple<L3Address, L3Address, int>>& dest_next_ttl = destNextTtl;
+    dest_next_ttl.clear();
     int i = 0;
     for (auto& d : dest){
-        if (nodeDataMap.count(d) != 0) {
-            NodeData data = nodeDataMap[d];
-            auto tupleValue = std::make_tuple(d, data.nextHop_address, ttl[i]); // @suppress("Function cannot be instantiated")
-            dest_next_ttl.push_back(tupleValue);
+        int slot = nodeTable.find(d);
+        if (slot >= 0) {
+            dest_next_ttl.emplace_back(d, nodeTable.getNextHop(slot), ttl[i]);
 
             //dest_next_ttl.push_back(std::make_tuple(d, data.nextHop_address, ttl[i]));
         }
@@ -1526,9 +1284,7 @@ void SimpleBroadcast1Hop::sendTaskTo(std::vector<L3Address>& dest, TaskREQ& task
     }
 
     if (dest_next_ttl.size() > 0) {
-        std::ostringstream str;
-        str << "Task-" << task.getGen_ipAddress().str() << "-" << task.getId() << "-" << reqSent;
-        Packet *packet = new Packet(str.str().c_str());
+        Packet *packet = new Packet("Task");
         if (dontFragment)
             packet->addTag<FragmentationReq>()->setDontFragment(true);
 
@@ -1537,17 +1293,20 @@ void SimpleBroadcast1Hop::sendTaskTo(std::vector<L3Address>& dest, TaskREQ& task
 
         packet->insertAtBack(payload);
 
-        for (auto& dd : dest_next_ttl)
-            EV_INFO << "Sending TASK to: " << std::get<0>(dd) << " passing from " << std::get<1>(dd) << " with ttl " << std::get<2>(dd)<< endl;
+        if (BW_LOG_DETAIL) {
+            for (auto& dd : dest_next_ttl)
+                EV_INFO << "Sending TASK to: " << std::get<0>(dd) << " passing from " << std::get<1>(dd) << " with ttl " << std::get<2>(dd)<< endl;
 
-        EV_INFO << "SENDING Packet name: " << packet->getName() << ", length: " << packet->getTotalLength() << "\n";
-        EV_INFO << "SENDING Tags:\n";
-        for (int i = 0; i < packet->getNumTags(); i++) {
-            auto tag = packet->getTag(i);
-            EV_INFO << "  Tag " << i << ": " << tag->str() << "\n";
+            EV_INFO << "SENDING Packet name: " << packet->getName() << ", length: " << packet->getTotalLength() << "\n";
+            EV_INFO << "SENDING Tags:\n";
+            for (int i = 0; i < packet->getNumTags(); i++) {
+                auto tag = packet->getTag(i);
+                EV_INFO << "  Tag " << i << ": " << tag->str() << "\n";
+            }
         }
 
-        socket.sendTo(packet, L3Address("255.255.255.255"), destPort);
+        trace(TRACE_TASK_SENT, traceId(task.getGen_ipAddress()), task.getId(), dest_next_ttl.size());
+        sendToSocket(packet, L3Address("255.255.255.255"));
         numSent++;
     }
     else {
@@ -1583,19 +1342,88 @@ void SimpleBroadcast1Hop::sendTaskTo(std::vector<L3Address>& dest, TaskREQ& task
 //    }
 }
 
-bool SimpleBroadcast1Hop::isDeployFeasibleLocal(TaskREQ& task) {
+void SimpleBroadcast1Hop::applyPeakLoad(simtime_t start, simtime_t end, NodeData& state)
+{
+    resourceLedger.advance(simTime());
+    ReservationCalendar::Load peak = resourceLedger.peak(std::max(start, simTime()), end);
+    state.compActUsage = peak[ReservationCalendar::CPU];
+    state.memoryActUsage = peak[ReservationCalendar::MEMORY];
+    state.lockedGPU = peak[ReservationCalendar::GPU] > 0;
+    state.lockedCamera = peak[ReservationCalendar::CAMERA] > 0;
+    state.lockedFly = peak[ReservationCalendar::FLY] > 0;
+}
+
+SimpleBroadcast1Hop::NodeData SimpleBroadcast1Hop::getMyNodeDataFor(const TaskREQ& task)
+{
+    // the task must fit for its whole lifetime, not only against the current load
     NodeData nd = getMyNodeData();
-    return isDeployFeasible(task, nd);
+    applyPeakLoad(task.getStart_timestamp(), task.getEnd_timestamp(), nd);
+    return nd;
+}
+
+void SimpleBroadcast1Hop::getMyTimeline(std::vector<LoadStep>& out)
+{
+    out.clear();
+    upcomingLoad.clear();
+    resourceLedger.advance(simTime());
+    resourceLedger.upcomingSteps(simTime(), capacityTimelineSteps, upcomingLoad);
+    for (const auto& change : upcomingLoad) {
+        LoadStep step;
+        step.time = change.first;
+        step.compActUsage = change.second[ReservationCalendar::CPU];
+        step.memoryActUsage = change.second[ReservationCalendar::MEMORY];
+        step.lockedGPU = change.second[ReservationCalendar::GPU] > 0;
+        step.lockedCamera = change.second[ReservationCalendar::CAMERA] > 0;
+        step.lockedFly = change.second[ReservationCalendar::FLY] > 0;
+        out.push_back(step);
+    }
+
+    LoadStep current;
+    current.compActUsage = resourceLedger.getCompUsage();
+    current.memoryActUsage = resourceLedger.getMemoryUsage();
+    current.lockedGPU = resourceLedger.isGPULocked();
+    current.lockedCamera = resourceLedger.isCameraLocked();
+    current.lockedFly = resourceLedger.isFlyLocked();
+    dropUnchangedSteps(current, out);
 }
 
-void SimpleBroadcast1Hop::deployTaskHere(TaskREQ& task)
+LoadStep SimpleBroadcast1Hop::foldNeighbourAggregates(const LoadStep& own) const
 {
+    if (neighbourAggregates.empty())
+        return own;
+    LoadStep folded;
+    folded.time = own.time;
+
+    //rule for CompActUsage and MemoryActUsage - choose the minor
+    folded.compActUsage = std::min(own.compActUsage, neighbourAggregates.getMinCompActUsage());
+    folded.memoryActUsage = std::min(own.memoryActUsage, neighbourAggregates.getMinMemoryActUsage());
+
+    //rule for LockedCamera - locked only if no camera is free
+    bool anyCamera = hasCamera || neighbourAggregates.anyCamera();
+    bool freeCamera = (hasCamera && !own.lockedCamera) || neighbourAggregates.anyFreeCamera();
+    folded.lockedCamera = anyCamera && !freeCamera;
+
+    //rule for LockedGPU - locked only if no GPU is free
+    bool anyGPU = hasGPU || neighbourAggregates.anyGPU();
+    bool freeGPU = (hasGPU && !own.lockedGPU) || neighbourAggregates.anyFreeGPU();
+    folded.lockedGPU = anyGPU && !freeGPU;
+
+    //rule for LockedFly - locked only if locked everywhere
+    folded.lockedFly = own.lockedFly && !neighbourAggregates.anyFreeFly();
+    return folded;
+}
+
+bool SimpleBroadcast1Hop::isDeployFeasibleLocal(const TaskREQ& task) {
+    return isDeployFeasible(task, getMyNodeDataFor(task));
+}
+
+void SimpleBroadcast1Hop::deployTaskHere(const TaskPtr& taskPtr)
+{
+    const TaskREQ& task = *taskPtr;
+
     //Check if already deployed
-    for (auto& at : assignedTask_list){
-        if ((at.getGen_ipAddress() == task.getGen_ipAddress()) && (at.getId() == task.getId())) {
-            return;
-        }
-    }
+    if (resourceLedger.contains(task.getGen_ipAddress(), task.getId()))
+        return;
 
     // Check if I have the capabilities
     if (!isDeployFeasibleLocal(task)) {
@@ -1603,15 +1431,18 @@ void SimpleBroadcast1Hop::deployTaskHere(TaskREQ& task)
         return;
     }
 
+    trace(TRACE_TASK_DEPLOYED, traceId(task.getGen_ipAddress()), task.getId());
     EV_INFO << "Deploying TASK NOW: " << task << endl;
-    assignedTask_list.push_back(task);
+    resourceLedger.add(task.getGen_ipAddress(), task.getId(), task.getReqCPU(), task.getReqMemory(),
+            task.getLockGPU(), task.getLockCamera(), task.getReq_lock_flyengine(),
+            task.getStart_timestamp(), task.getEnd_timestamp(), simTime());
 
-    Task_deploy_extra_info extra;
-    extra.deploy_time = simTime();
-    extra.node_pos_coord_x = mob->getCurrentPosition().x;
-    extra.node_pos_coord_y = mob->getCurrentPosition().y;
-    extra.deploy_hops = task.getHops_to_deploy();
-    extra_info_deploy_tasks[std::make_pair(task.getGen_ipAddress(), task.getId())] = extra;
+    TaskDeployedDetails details;
+    details.task = &task;
+    details.node = myAddress;
+    details.coordX = mob->getCurrentPosition().x;
+    details.coordY = mob->getCurrentPosition().y;
+    emit(taskDeployedSignal, &details);
 
     // If not already deployed, record the deployment time
     simtime_t generationTime = task.getGen_timestamp();
@@ -1623,31 +1454,43 @@ void SimpleBroadcast1Hop::deployTaskHere(TaskREQ& task)
 
 }
 
-void SimpleBroadcast1Hop::manageNewTask(TaskREQ& task, bool generatedHereNow, L3Address avoidAddress)
+void SimpleBroadcast1Hop::manageNewTask(const TaskPtr& taskPtr, bool generatedHereNow, L3Address avoidAddress)
 {
+    const TaskREQ& task = *taskPtr;
     L3Address loopbackAddress("127.0.0.1");
-    std::vector<L3Address> deployDest_out;
-    std::vector<int> ttls;
+    std::vector<L3Address> deployDest_out = destPool.acquire();
+    std::vector<int> ttls = ttlPool.acquire();
     std::vector<L3Address> deployDest = checkDeployDestination(task);
+    trace(TRACE_DECISION, traceId(task.getGen_ipAddress()), task.getId(), deployDest.size());
 
     if (generatedHereNow) {
         Task_generated_extra_info extra;
         extra.generation_time = simTime();
         //getting theoretical deployable nodes
-        int nnodes = this->getParentModule()->getVectorSize();
-        for (int n = 0; n < nnodes; ++n) {
-            SimpleBroadcast1Hop *appn = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n)->getSubmodule("app", 0));
-            L3Address n_ipaddr = appn->myAddress;
-            NodeData n_data = appn->getMyNodeData();
-
-            if (isDeployFeasible(task, n_data) ) {
-                extra.deployable_nodes_at_generation.push_back(n_ipaddr);
+        if (registry != nullptr) {
+            registry->findFeasible(toRequirements(task), task.getStart_timestamp(), task.getEnd_timestamp(),
+                    extra.deployable_nodes_at_generation);
+        }
+        else {
+            int nnodes = this->getParentModule()->getVectorSize();
+            for (int n = 0; n < nnodes; ++n) {
+                SimpleBroadcast1Hop *appn = check_and_cast<SimpleBroadcast1Hop *>(this->getParentModule()->getParentModule()->getSubmodule("host", n)->getSubmodule("app", 0));
+                L3Address n_ipaddr = appn->myAddress;
+                NodeData n_data = appn->getMyNodeDataFor(task);
+
+                if (isDeployFeasible(task, n_data) ) {
+                    extra.deployable_nodes_at_generation.push_back(n_ipaddr);
+                }
             }
         }
 
         extra.decision_nodes_at_generation.insert(extra.decision_nodes_at_generation.end(), deployDest.begin(), deployDest.end());
 
-        extra_info_generated_tasks[std::make_pair(task.getGen_ipAddress(), task.getId())] = extra;
+        TaskGeneratedDetails details;
+        details.task = &task;
+        details.deployableNodes = &extra.deployable_nodes_at_generation;
+        details.decisionNodes = &extra.decision_nodes_at_generation;
+        emit(taskGeneratedSignal, &details);
     }
 
 
@@ -1659,7 +1502,7 @@ void SimpleBroadcast1Hop::manageNewTask(TaskREQ& task, bool generatedHereNow, L3
         for (auto& dest : deployDest) {
             EV_INFO << "Dest:" << dest << endl;
             if ((dest == loopbackAddress) || (dest == myAddress)) {
-                deployTaskHere(task);
+                deployTaskHere(taskPtr);
             }
             else {
                 deployDest_out.push_back(dest);
@@ -1671,7 +1514,7 @@ void SimpleBroadcast1Hop::manageNewTask(TaskREQ& task, bool generatedHereNow, L3
             //sendTaskTo(deployDest_out, task, ttls);
 
             if (forwardingTask_queue.empty()) {
-                scheduleClockEventAfter(uniform(0, maxForwardDelay), taskForwardMsg);
+                scheduleClockEventAfter(uniform(0, maxForwardDelay, forwardingRng), taskForwardMsg);
             }
 
             /*
@@ -1686,78 +1529,69 @@ void SimpleBroadcast1Hop::manageNewTask(TaskREQ& task, bool generatedHereNow, L3
             */
 
             // Enqueue
-            Forwarding_Task ft;
-            ft.dests = deployDest_out;
-            ft.task = task;
-            ft.ttls = ttls;
-            ft.numberOfSending = 0;
-            forwardingTask_queue.push(ft);
+            enqueueForwarding(taskPtr, deployDest_out, ttls);
 
 
             //reqSent++;
         }
     }
+    destPool.release(deployDest_out);
+    ttlPool.release(ttls);
+}
+
+void SimpleBroadcast1Hop::enqueueForwarding(const TaskPtr& task, std::vector<L3Address>& dests, std::vector<int>& ttls, uint numberOfSending)
+{
+    // the queue entry takes over the vectors, the caller is left with empty ones
+    Forwarding_Task ft;
+    ft.dests = std::move(dests);
+    ft.task = task;
+    ft.ttls = std::move(ttls);
+    ft.numberOfSending = numberOfSending;
+    forwardingTask_queue.push(std::move(ft));
+    dests.clear();
+    ttls.clear();
 }
 
 void SimpleBroadcast1Hop::processTaskREQ_ACKmessage(const Ptr<const TaskREQ_ACKmessage>payload, L3Address srcAddr, L3Address destAddr)
 {
     debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::begin\n");
-    TaskREQ t = payload->getTask();
+    const TaskREQ& t = payload->getTask();
 
     if (payload->getDest_ipAddress() == myAddress) {
 
+        trace(TRACE_ACK_RECEIVED, traceId(t.getGen_ipAddress()), t.getId(), traceId(payload->getSrc_ipAddress()));
         EV_INFO << myAddress << " - RECEIVED TASK ACK. " << t.getGen_ipAddress() << "-" << t.getId() << endl;
 
-        debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1\n");
-
-        for (auto it = ackVector.begin(); it != ackVector.end(); )
-        {
-            debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1\n");
-
-            if ((t.getGen_ipAddress() == it->ft.task.getGen_ipAddress()) && (t.getId() == it->ft.task.getId())) {
-
-                debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1_1\n");
-
-                int idx_erase = -1;
-                int idx = 0;
-                for (auto& el : it->non_ack_dests) {
-                    if (payload->getSrc_ipAddress() == el) {
-                        idx_erase = idx;
-                    }
-                    idx++;
-                }
-
-                debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1_2\n");
-
-                debugPrint("it->non_ack_dests size: %d \nit->non_ack_ttls size: %d \nidx_erase: %d \n \n",
-                        (int)it->non_ack_dests.size(), (int)it->non_ack_ttls.size(), idx_erase);
+        TaskAckedDetails details;
+        details.task = &t;
+        details.node = payload->getSrc_ipAddress();
+        emit(taskAckedSignal, &details);
 
-                if (idx_erase >= 0) {
-                    it->non_ack_dests.erase(it->non_ack_dests.begin() + idx_erase);
-                    it->non_ack_ttls.erase(it->non_ack_ttls.begin() + idx_erase);
-                }
-
-                debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1_3\n");
+        debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1\n");
 
-                if (it->non_ack_dests.size() == 0) {
-                    // Remove the element from ackVector; erase returns an iterator
-                    // pointing to the next element after the erased one
-                    it = ackVector.erase(it);
-                }
-                else {
-                    ++it;
+        auto idx = ackIndex.find(AckKey{t.getGen_ipAddress(), (uint32_t)t.getId(), payload->getSrc_ipAddress()});
+        if (idx != ackIndex.end()) {
+            // one ACK clears one occurrence of the destination (the last one) in every entry of the task
+            std::vector<std::pair<long, int>>& refs = idx->second;
+            long lastEntry = -1;
+            for (size_t k = refs.size(); k-- > 0; ) {
+                if (refs[k].first == lastEntry)
+                    continue;
+                lastEntry = refs[k].first;
+
+                Ack_Forwarding_Task& aft = ackEntries.at(lastEntry);
+                aft.acked[refs[k].second] = true;
+                if (--aft.numPending == 0) {
+                    releaseForwarding(aft.ft);
+                    ackEntries.erase(lastEntry);
                 }
-
-                debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1_4\n");
-            }
-            else
-            {
-                debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_1_5\n");
-                // Only advance if we haven't erased
-                ++it;
+                refs[k].first = -1;
             }
+            refs.erase(std::remove_if(refs.begin(), refs.end(), [](const std::pair<long, int>& r) { return r.first < 0; }), refs.end());
+            if (refs.empty())
+                ackIndex.erase(idx);
 
-            debugPrint("SimpleBroadcast1Hop::processTaskREQ_ACKmessage::1_2\n");
+            rescheduleAckTimer();
         }
 
     }
@@ -1769,16 +1603,16 @@ void SimpleBroadcast1Hop::processTaskREQ_ACKmessage(const Ptr<const TaskREQ_ACKm
 
 void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>payload, L3Address srcAddr, L3Address destAddr)
 {
-    std::vector<L3Address> deployDest_out;
-    std::vector<int> ttlDest_out;
-    TaskREQ t = payload->getTask();
+    std::vector<L3Address> deployDest_out = destPool.acquire();
+    std::vector<int> ttlDest_out = ttlPool.acquire();
+    TaskREQ t = payload->getTask(); // local copy: hops_to_deploy is updated below
     bool to_ack = false;
 
+    trace(TRACE_TASK_RECEIVED, traceId(t.getGen_ipAddress()), t.getId(), traceId(srcAddr));
     EV_INFO << myAddress << " - RECEIVED TASK. " << t.getGen_ipAddress() << "-" << t.getId() << "-" << payload->getIdReqMessage() << endl;
 
 
     //std::tuple<L3Address, uint32_t, uint32_t> packetId = std::make_tuple(t.getGen_ipAddress(), t.getId(), payload->getIdReqMessage());
-    std::pair<L3Address, uint32_t> packetId = std::make_pair(t.getGen_ipAddress(), t.getId());
     //if (relayedPackets.find(packetId) == relayedPackets.end()) {
     // We not yet relayed this packet
     //relayedPackets.insert(packetId);
@@ -1804,9 +1638,9 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
             int act_ttl = dd.getTtl();
 
             if (finalDest == myAddress) {
-                if (extra_info_deploy_tasks.count(packetId) == 0) {
+                if (!resourceLedger.contains(t.getGen_ipAddress(), t.getId())) {
                     EV_INFO << "RECEIVED TASK. It's for me! Deploying..." << endl;
-                    deployTaskHere(t);
+                    deployTaskHere(std::make_shared<const TaskREQ>(t));
                 }
             }
             else if (nexthopDest == myAddress) {
@@ -1829,9 +1663,9 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
         for (int i = 0; i < deployIpOptions.size(); ++i) {
             L3Address finalDest = deployIpOptions[i];
             if (finalDest == myAddress) {
-                if (extra_info_deploy_tasks.count(packetId) == 0) {
+                if (!resourceLedger.contains(t.getGen_ipAddress(), t.getId())) {
                     EV_INFO << "RECEIVED TASK. It's for me! Deploying..." << endl;
-                    deployTaskHere(t);
+                    deployTaskHere(std::make_shared<const TaskREQ>(t));
                     to_ack = true;
                 }
             } else {
@@ -1845,8 +1679,7 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
 
     //FORWARDING
     if (deployDest_out.size() > 0) {
-        if (relayedPackets.find(packetId) == relayedPackets.end()) {
-            relayedPackets.insert(packetId);
+        if (relayFilter.insert(t.getGen_ipAddress(), t.getId(), simTime())) {
 
 
             EV_INFO << "RECEIVED TASK. Not for me but need to relay. Sending out" << endl;
@@ -1854,7 +1687,7 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
             // sendTaskTo(deployDest_out, t, ttlDest_out);
 
             if (forwardingTask_queue.empty()) {
-                scheduleClockEventAfter(uniform(0, maxForwardDelay), taskForwardMsg);
+                scheduleClockEventAfter(uniform(0, maxForwardDelay, forwardingRng), taskForwardMsg);
             }
 
             /*
@@ -1869,26 +1702,21 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
              */
 
             // Enqueue
-            Forwarding_Task ft;
-            ft.dests = deployDest_out;
-            ft.task = t;
-            ft.ttls = ttlDest_out;
-            ft.numberOfSending = 0;
-            forwardingTask_queue.push(ft);
+            enqueueForwarding(std::make_shared<const TaskREQ>(t), deployDest_out, ttlDest_out);
         }
         else {
             EV_INFO << "TASK from " << t.getGen_ipAddress() << ", ID: " << t.getId() << " already managed. Skipping this" << endl;
         }
 
     }
+    destPool.release(deployDest_out);
+    ttlPool.release(ttlDest_out);
 
     if ((to_ack) && (ack_func)) {
 
         EV_INFO << "Sending ACK for this TASK" << endl;
 
-        std::ostringstream str;
-        str << "Ack-" << t.getGen_ipAddress().str() << "-" << t.getId();
-        Packet *packet = new Packet(str.str().c_str());
+        Packet *packet = new Packet("Ack");
         if (dontFragment)
             packet->addTag<FragmentationReq>()->setDontFragment(true);
 
@@ -1904,12 +1732,13 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
         payload->setDest_ipAddress(srcAddr);
 
 
+        trace(TRACE_ACK_SENT, traceId(t.getGen_ipAddress()), t.getId(), traceId(srcAddr));
         EV_INFO << "Sending ACK for this TASK. SRC: " << myAddress << "; DEST: " << srcAddr << endl;
 
 
         packet->insertAtBack(payload);
 
-        socket.sendTo(packet, L3Address("255.255.255.255"), destPort);
+        sendToSocket(packet, L3Address("255.255.255.255"));
         numSent++;
 
     }
@@ -1991,22 +1820,62 @@ void SimpleBroadcast1Hop::processTaskREQmessage(const Ptr<const TaskREQmessage>p
 
 void SimpleBroadcast1Hop::generateNewTask()
 {
-    TaskREQ newTask = parseTask();  //here the function that PARSE the SG script
-
-    EV_INFO << "Generating new TASK: " << newTask << endl;
+    TaskPtr newTask = std::make_shared<const TaskREQ>(parseTask());  //here the function that PARSE the SG script
 
-    std::pair<L3Address, uint32_t> packetId = std::make_pair(newTask.getGen_ipAddress(), newTask.getId());
-    relayedPackets.insert(packetId);
+    EV_INFO << "Generating new TASK: " << *newTask << endl;
 
-    generatedTask_list.push_back(newTask);
+    relayFilter.insert(newTask->getGen_ipAddress(), newTask->getId(), simTime());
 
     manageNewTask(newTask, true);
 }
 
+void SimpleBroadcast1Hop::handleMessage(cMessage *msg)
+{
+    try {
+        ClockUserModuleMixin::handleMessage(msg);
+    }
+    catch (std::exception& e) {
+        // the events leading to the error are the interesting ones
+        dumpTrace(e.what());
+        throw;
+    }
+}
+
+void SimpleBroadcast1Hop::dumpTrace(const char *reason)
+{
+    if (!traceRing.isEnabled() || traceDumped)
+        return;
+    traceDumped = true;
+
+    if (traceRingFile.empty()) {
+        std::cout << getFullPath() << " trace (" << reason << "): ";
+        traceRing.writeText(std::cout, traceEventNames, NUM_TRACE_EVENTS);
+        std::cout.flush();
+        return;
+    }
+
+    // one file per host, next to each other
+    std::string fileName = traceRingFile + "." + getParentModule()->getFullName();
+    FILE *f = fopen(fileName.c_str(), "wb");
+    if (f == nullptr) {
+        EV_WARN << "Cannot open trace file " << fileName << endl;
+        return;
+    }
+    bool ok = traceRing.writeBinary(f);
+    ok &= fclose(f) == 0;
+    if (!ok)
+        EV_WARN << "Error writing trace file " << fileName << endl;
+}
+
 void SimpleBroadcast1Hop::handleMessageWhenUp(cMessage *msg)
 {
     if (msg->isSelfMessage()) {
-        if(msg == selfMsg){
+        if (inputLog.isOpen())
+            inputLog.recordPosition(simTime(), mob->getCurrentPosition());
+
+        if (msg == replayMsg)
+            processReplay();
+        else if(msg == selfMsg){
             switch (selfMsg->getKind()) {
             case START:
                 processStart();
@@ -2046,7 +1915,7 @@ void SimpleBroadcast1Hop::handleMessageWhenUp(cMessage *msg)
 
                 if (!forwardingTask_queue.empty()) {
                     // Generate a random delay uniformly in [0, maxDelay]
-                    double randomDelay = uniform(0, maxForwardDelay);
+                    double randomDelay = uniform(0, maxForwardDelay, forwardingRng);
                     // Schedule the self-message after this delay
                     scheduleAfter(randomDelay, taskForwardMsg);
                 }
@@ -2063,8 +1932,6 @@ void SimpleBroadcast1Hop::handleMessageWhenUp(cMessage *msg)
             switch (taskAckMsg->getKind()) {
             case ACK_CHECK:
                 ackTask();
-
-                scheduleClockEventAfter(truncnormal(1, 0.01), taskAckMsg);
                 break;
 
             default:
@@ -2078,6 +1945,38 @@ void SimpleBroadcast1Hop::handleMessageWhenUp(cMessage *msg)
         socket.processMessage(msg);
 }
 
+void SimpleBroadcast1Hop::sendToSocket(Packet *packet, const L3Address& destAddr)
+{
+    // the replayed node only consumes inputs
+    if (replaying) {
+        delete packet;
+        return;
+    }
+    socket.sendTo(packet, destAddr, destPort);
+}
+
+void SimpleBroadcast1Hop::scheduleNextReplay()
+{
+    if (replayLog.next(replayRecord))
+        scheduleAt(std::max(replayRecord.time, simTime()), replayMsg);
+}
+
+void SimpleBroadcast1Hop::processReplay()
+{
+    replayMobility->setPosition(replayRecord.position);
+    if (replayRecord.payload != nullptr) {
+        // as processPacket() would have done on reception
+        const Ptr<const Chunk> chunk = replayRecord.payload;
+        auto it = packetHandlers.find(std::type_index(typeid(*chunk)));
+        if (it == packetHandlers.end())
+            throw cRuntimeError("Replayed payload of type %s has no handler", opp_typename(typeid(*chunk)));
+        it->second(this, chunk, replayRecord.srcAddr, replayRecord.destAddr);
+        numReceived++;
+    }
+    replayRecord.payload = nullptr;
+    scheduleNextReplay();
+}
+
 void SimpleBroadcast1Hop::socketDataArrived(UdpSocket *socket, Packet *packet)
 {
     // process incoming packet
@@ -2165,81 +2064,15 @@ void SimpleBroadcast1Hop::processHeartbeat(const Ptr<const Heartbeat>payload, L3
     data.num_hops = 1;
 
     data.radius = payload->getRadius();
+    readCapacityTimeline(*payload, data.compMaxUsage, data.memoryMaxUsage, data.timeline);
 
-    // Store or update the data in the map
-    nodeDataMap[srcAddr] = data;
-
-    updateRadius();
+    // Store or update the data in the table
+    nodeTable.upsert(srcAddr, data);
+    trace(TRACE_HEARTBEAT_RECEIVED, traceId(srcAddr), payload->getSequenceNumber());
 
     if (dissType == HIERARCHICAL) {
-        size_t nodeArraySize = payload->getNodeInfoListArraySize();
-        for (int i = 0; i < nodeArraySize; ++i) {
-            NodeInfo nf = payload->getNodeInfoList(i);
-            L3Address node_addr = nf.getIpAddress();
-
-            if ((node_addr != loopbackAddress) && (node_addr != myAddress)) {
-
-                int tmp_num_hops = 100000;
-                L3Address tmp_nextHop_address = L3Address();
-                if (nodeDataMap.count(node_addr) != 0) {
-                    tmp_nextHop_address = nodeDataMap[node_addr].nextHop_address;
-                    tmp_num_hops = nodeDataMap[node_addr].num_hops;
-                }
-
-                if (    (nodeDataMap.count(node_addr) == 0) ||
-                        (nodeDataMap[node_addr].timestamp < nf.getTimestamp())
-                ){
-                    // Create or update the data associated with this IP address
-                    NodeData data_nest;
-
-
-                    data_nest.timestamp = nf.getTimestamp();
-                    data_nest.sequenceNumber = nf.getSequenceNumber();
-                    data_nest.address = nf.getIpAddress();
-                    data_nest.coord_x = nf.getCoord_x();
-                    data_nest.coord_y = nf.getCoord_y();
-
-                    data_nest.memoryActUsage = nf.getMemoryActUsage();
-                    data_nest.memoryMaxUsage = nf.getMemoryMaxUsage();
-                    data_nest.compActUsage = nf.getCompActUsage();
-                    data_nest.compMaxUsage = nf.getCompMaxUsage();
-
-                    data_nest.hasCamera = nf.getHasCamera();
-                    data_nest.lockedCamera = nf.getLockedCamera();
-
-                    data_nest.hasGPU = nf.getHasGPU();
-                    data_nest.lockedGPU = nf.getLockedGPU();
-
-                    data_nest.lockedFly = nf.getLockedFly();
-
-                    data_nest.nextHop_address = payload->getIpAddress();
-                    data_nest.num_hops = nf.getNum_hops() + 1;
-                    data_nest.radius = nf.getRadius();
-
-    //                if (    (nodeDataMap.count(node_addr) != 0) &&
-    //                        (nodeDataMap[node_addr].num_hops < nf.getNum_hops())
-    //                ){
-    //                    data_nest.nextHop_address = nodeDataMap[node_addr].nextHop_address;
-    //                    data_nest.num_hops = nodeDataMap[node_addr].num_hops;
-    //                }
-    //                else {
-    //                    data_nest.nextHop_address = payload->getIpAddress();
-    //                    data_nest.num_hops = nf.getNum_hops() + 1;
-    //                }
-
-                    // Store or update the data in the map
-                    nodeDataMap[node_addr] = data_nest;
-                }
-
-                // Old next_hop was better
-                if (    (nodeDataMap.count(node_addr) != 0) &&
-                        (nodeDataMap[node_addr].num_hops > tmp_num_hops)
-                ){
-                    nodeDataMap[node_addr].nextHop_address = tmp_nextHop_address;
-                    nodeDataMap[node_addr].num_hops = tmp_num_hops;
-                }
-            }
-        }
+        int changed = mergeNodeInfoList(*payload);
+        EV_INFO << "Heartbeat from " << srcAddr << ": " << changed << " of " << payload->getNodeInfoListArraySize() << " entries changed" << endl;
     }
 
     // Log the extracted information
@@ -2248,21 +2081,83 @@ void SimpleBroadcast1Hop::processHeartbeat(const Ptr<const Heartbeat>payload, L3
 
 }
 
+// Heartbeat node list as seen by DecisionEngine::mergeSortedList()
+namespace {
+struct NodeInfoListView
+{
+    typedef NodeData Data;
+    const Heartbeat& payload;
+
+    size_t size() const { return payload.getNodeInfoListArraySize(); }
+    const L3Address& key(size_t i) const { return payload.getNodeInfoList(i).getIpAddress(); }
+    simtime_t timestamp(size_t i) const { return payload.getNodeInfoList(i).getTimestamp(); }
+    int numHops(size_t i) const { return payload.getNodeInfoList(i).getNum_hops(); }
+    void read(size_t i, NodeData& data) const {
+        const NodeInfo& nf = payload.getNodeInfoList(i);
+        data.timestamp = nf.getTimestamp();
+        data.sequenceNumber = nf.getSequenceNumber();
+        data.address = nf.getIpAddress();
+        data.coord_x = nf.getCoord_x();
+        data.coord_y = nf.getCoord_y();
+
+        data.memoryActUsage = nf.getMemoryActUsage();
+        data.memoryMaxUsage = nf.getMemoryMaxUsage();
+        data.compActUsage = nf.getCompActUsage();
+        data.compMaxUsage = nf.getCompMaxUsage();
+
+        data.hasCamera = nf.getHasCamera();
+        data.lockedCamera = nf.getLockedCamera();
+
+        data.hasGPU = nf.getHasGPU();
+        data.lockedGPU = nf.getLockedGPU();
+
+        data.lockedFly = nf.getLockedFly();
+
+        data.radius = nf.getRadius();
+        readCapacityTimeline(nf, data.compMaxUsage, data.memoryMaxUsage, data.timeline);
+        std::fill(data.lastSeqNumber, data.lastSeqNumber + 16, 0);
+    }
+};
+} // namespace
+
+int SimpleBroadcast1Hop::mergeNodeInfoList(const Heartbeat& payload)
+{
+    L3Address loopbackAddress("127.0.0.1"); // Define the loopback address
+    NodeInfoListView list{payload};
+    return DecisionEngine::mergeSortedList(nodeTable, list, payload.getIpAddress(), myAddress, loopbackAddress);
+}
+
+template<typename T, void (SimpleBroadcast1Hop::*process)(const Ptr<const T>, L3Address, L3Address)>
+void SimpleBroadcast1Hop::dispatch(SimpleBroadcast1Hop *self, const Ptr<const Chunk>& chunk, L3Address srcAddr, L3Address destAddr)
+{
+    (self->*process)(staticPtrCast<const T>(chunk), srcAddr, destAddr);
+}
+
+void SimpleBroadcast1Hop::registerPacketHandlers()
+{
+    packetHandlers[std::type_index(typeid(Heartbeat))] = &dispatch<Heartbeat, &SimpleBroadcast1Hop::processHeartbeat>;
+    packetHandlers[std::type_index(typeid(ChangesBlock))] = &dispatch<ChangesBlock, &SimpleBroadcast1Hop::processChangesBlock>;
+    packetHandlers[std::type_index(typeid(TaskREQmessage))] = &dispatch<TaskREQmessage, &SimpleBroadcast1Hop::processTaskREQmessage>;
+    packetHandlers[std::type_index(typeid(TaskREQ_ACKmessage))] = &dispatch<TaskREQ_ACKmessage, &SimpleBroadcast1Hop::processTaskREQ_ACKmessage>;
+}
+
 void SimpleBroadcast1Hop::processPacket(Packet *pk)
 {
     emit(packetReceivedSignal, pk);
-    EV_INFO << "Received packet: " << UdpSocket::getReceivedPacketInfo(pk) << endl;
-    printPacket(pk);
+    if (BW_LOG_DETAIL) {
+        EV_INFO << "Received packet: " << UdpSocket::getReceivedPacketInfo(pk) << endl;
+        printPacket(pk);
 
 
-    //auto bytesChunk = pk->peekAllAsBytes();
-    //EV_INFO << "Raw packet bytes: " << bytesChunk->str() << endl;
+        //auto bytesChunk = pk->peekAllAsBytes();
+        //EV_INFO << "Raw packet bytes: " << bytesChunk->str() << endl;
 
-    EV_INFO << "Packet name: " << pk->getName() << ", length: " << pk->getTotalLength() << "\n";
-    EV_INFO << "Tags:\n";
-    for (int i = 0; i < pk->getNumTags(); i++) {
-        auto tag = pk->getTag(i);
-        EV_INFO << "  Tag " << i << ": " << tag->str() << "\n";
+        EV_INFO << "Packet name: " << pk->getName() << ", length: " << pk->getTotalLength() << "\n";
+        EV_INFO << "Tags:\n";
+        for (int i = 0; i < pk->getNumTags(); i++) {
+            auto tag = pk->getTag(i);
+            EV_INFO << "  Tag " << i << ": " << tag->str() << "\n";
+        }
     }
 
     // Extract the sender's IP address
@@ -2277,56 +2172,19 @@ void SimpleBroadcast1Hop::processPacket(Packet *pk)
         destAddr = addresses->getDestAddress();
     }
 
-    std::string s = pk->getName();
-
-    EV_INFO << myAddress << " - Received packet: " << s << ", srcAddr: " << srcAddr << "\n";
+    EV_INFO << myAddress << " - Received packet: " << pk->getName() << ", srcAddr: " << srcAddr << "\n";
 
     if ((srcAddr != loopbackAddress) && (srcAddr != myAddress)) {
-
-//        auto taskPayload = pk->peekAtBack<TaskREQmessage>(b(-1), 0);
-//        if (taskPayload != nullptr) {
-//            // It's indeed a TaskREQmessage chunk
-//            processTaskREQmessage(taskPayload, srcAddr, destAddr);
-//        }
-//        else {
-//            auto heartbeatPayload = pk->peekAtBack<Heartbeat>(b(-1), 0);
-//            if (heartbeatPayload != nullptr) {
-//                // It's a Heartbeat
-//                processHeartbeat(heartbeatPayload, srcAddr, destAddr);
-//            }
-//            else {
-//                EV_WARN << "No recognized chunk at the back.\n";
-//            }
-//        }
-
-        // Process here
-        // Check if the packet contains Heartbeat data
-        //if ((s.rfind("Heartbeat", 0)) && (pk->hasData<Heartbeat>())) {
-
-        if (s.rfind("Heartbeat", 0) == 0) {
-            // Extract the Heartbeat payload
-            const auto& payload = pk->peekData<Heartbeat>();
-            processHeartbeat(payload, srcAddr, destAddr);
-        } else if (s.rfind("Changes", 0) == 0) {
-            // Extract the ChangesBlock payload
-            const auto& payload = pk->peekData<ChangesBlock>();
-            processChangesBlock(payload, srcAddr, destAddr);
-        } else if (s.rfind("Task", 0) == 0) {
-            // Extract the TaskREQmessage payload
-            const auto& payload = pk->peekData<TaskREQmessage>();
-
-            processTaskREQmessage(payload, srcAddr, destAddr);
-        }
-        else if (s.rfind("Ack", 0) == 0) {
-            // Extract the TaskREQ_ACKmessage payload
-            const auto& payload = pk->peekData<TaskREQ_ACKmessage>();
-
-            processTaskREQ_ACKmessage(payload, srcAddr, destAddr);
-        }
-        else {
-            EV_WARN << "Received packet does not contain a Heartbeat payload." << endl;
+        // dispatch on the type of the payload chunk, the packet name is not significant
+        const auto& chunk = pk->peekData();
+        auto it = packetHandlers.find(std::type_index(typeid(*chunk)));
+        if (it != packetHandlers.end()) {
+            if (inputLog.isOpen())
+                inputLog.recordPayload(simTime(), mob->getCurrentPosition(), srcAddr, destAddr, *chunk);
+            it->second(this, chunk, srcAddr, destAddr);
         }
-
+        else
+            EV_WARN << "Received packet does not contain a known payload." << endl;
     }
 
     delete pk;
@@ -2361,20 +2219,12 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
 
     //update NodeInfo with assigned tasks
 
-    double compActUsage = 0;
-    double memActUsage = 0;
-    bool lockedGPU = false;
-    bool lockedCamera = false;
-    bool lockedFly = false;
-    for (size_t i = 0; i < assignedTask_list.size(); ++i) {
-        if ((simTime() < assignedTask_list[i].getEnd_timestamp()) && (simTime() >= assignedTask_list[i].getStart_timestamp())){
-            compActUsage += assignedTask_list[i].getReqCPU();
-            memActUsage += assignedTask_list[i].getReqMemory();
-            if (assignedTask_list[i].getLockGPU()) lockedGPU = true;
-            if (assignedTask_list[i].getLockCamera()) lockedCamera = true;
-            if (assignedTask_list[i].getReq_lock_flyengine()) lockedFly = true;
-        }
-    }
+    resourceLedger.advance(simTime());
+    double compActUsage = resourceLedger.getCompUsage();
+    double memActUsage = resourceLedger.getMemoryUsage();
+    bool lockedGPU = resourceLedger.isGPULocked();
+    bool lockedCamera = resourceLedger.isCameraLocked();
+    bool lockedFly = resourceLedger.isFlyLocked();
 
 
     const auto& payload = makeShared<ChangesBlock>();
@@ -2402,12 +2252,12 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldPOS_x);
         ch.setValue(mob->getCurrentPosition().x);
         lastReport.setCoord_x(mob->getCurrentPosition().x);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
 
         ch.setParammeter(fldPOS_y);
         ch.setValue(mob->getCurrentPosition().y);
         lastReport.setCoord_y(mob->getCurrentPosition().y);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
 
     }
 
@@ -2416,7 +2266,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldMaxCPU);
         ch.setValue(computationalPower);
         lastReport.setCompMaxUsage(computationalPower);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (lastReport.getMemoryMaxUsage() != availableMaxMemory) {
@@ -2424,7 +2274,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldMaxMEM);
         ch.setValue(availableMaxMemory);
         lastReport.setMemoryMaxUsage(availableMaxMemory);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
 
     }
 
@@ -2433,7 +2283,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldActCPU);
         ch.setValue(compActUsage);
         lastReport.setCompActUsage(compActUsage);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (abs(lastReport.getMemoryActUsage() - memActUsage) > deltaMemory) {
@@ -2441,7 +2291,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldActMEM);
         ch.setValue(memActUsage);
         lastReport.setMemoryActUsage(memActUsage);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
 
     }
 
@@ -2450,7 +2300,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldCAM);
         ch.setValue((hasCamera ? 1 : 0));
         lastReport.setHasCamera(hasCamera);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (lastReport.getHasGPU() != hasGPU) {
@@ -2458,7 +2308,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldGPU);
         ch.setValue((hasGPU? 1 : 0));
         lastReport.setHasGPU(hasGPU);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (lastReport.getLockedCamera() != lockedCamera) {
@@ -2466,7 +2316,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldLkCAM);
         ch.setValue((lockedCamera ? 1 : 0));
         lastReport.setLockedCamera(lockedCamera);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (lastReport.getLockedFly() != lockedFly) {
@@ -2474,7 +2324,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldLkFLY);
         ch.setValue((lockedFly ? 1 : 0));
         lastReport.setLockedFly(lockedFly);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
 
     }
 
@@ -2483,7 +2333,7 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
         ch.setParammeter(fldLkGPU);
         ch.setValue((lockedGPU ? 1 : 0));
         lastReport.setLockedGPU(lockedGPU);
-        stChanges.push_back(ch);
+        stChanges.push(ch);
     }
 
     if (stksize < stChanges.size()) {
@@ -2493,14 +2343,17 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
     //avoid packet oversize
     int i = 0;
     while (!stChanges.empty() && i<500){
-        Change cht = stChanges.at(0);
-        payload->appendChangesList(cht);
-        stChanges.pop_front();
+        payload->appendChangesList(stChanges.front());
+        stChanges.pop();
         i++;
     }
 
 
 
+    // my reservations, which no change carries
+    getMyTimeline(timelineSteps);
+    writeCapacityTimeline(*payload, timelineSteps, computationalPower, availableMaxMemory);
+
     payload->setChangesCount(payload->getChangesListArraySize());
     if (payload->getChangesListArraySize() > 0) {
         EV_INFO << "sending  " << payload->getChangesListArraySize() << " changes " << std::endl;
@@ -2514,12 +2367,12 @@ Ptr<ChangesBlock> SimpleBroadcast1Hop::createChangesPayload()
     //printf("sizeof(ChangesBlock): %d; sizeof(Change): %d; payload->getChangesListArraySize(): %d, SUM: %d \n",
     //        sizeof(ChangesBlock), sizeof(Change), payload->getChangesListArraySize(), s);fflush(stdout);
 
-    uint32_t s2 = sizeof(ChangesBlock) + payload->getChangesListArraySize() * (sizeof(uint8_t) + sizeof(double));
+    uint32_t s2 = sizeof(ChangesBlock) + payload->getChangesListArraySize() * (sizeof(uint8_t) + sizeof(double))
+            + payload->getCapacityTimelineArraySize() * sizeof(CapacityStep);
     //printf("sizeof(ChangesBlock): %d; sizeof(Change): %d; payload->getChangesListArraySize(): %d, SUM: %d \n",
     //            sizeof(ChangesBlock), (sizeof(uint8_t) + sizeof(double)), payload->getChangesListArraySize(), s2);fflush(stdout);
 
-    netPktSize += s2;
-    if (simTime() <= startMakingStats) netPktSize_beforeStart += s2;
+    countInfoPacket(s2);
 
     //payload->setChunkLength(B(s));
     payload->setChunkLength(B(par("messageLength")));
@@ -2535,41 +2388,57 @@ void SimpleBroadcast1Hop::processChangesBlock(const Ptr<const ChangesBlock>paylo
     // std::cout << "Received ChangesBlock! Changes:" << payload->getChangesCount() <<  std::endl;
     L3Address loopbackAddress("127.0.0.1"); // Define the loopback address
 
-    //Change *ch = new Change[payload->getChangesCount()];
-    Change ch;
+    trace(TRACE_CHANGES_RECEIVED, traceId(srcAddr), payload->getChangesCount());
+
+    // 1st pass: resolve (or create) the slot of every change, in block order
+    blockSlots.clear();
+    int lastSlot = -1;
     for (int i=0; i<payload->getChangesCount(); i++){
-        ch = payload->getChangesList(i);
+        const Change& ch = payload->getChangesList(i);
 //        std::cout << ch.getIpAddress() << " | " << ((int) ch.getParammeter()) << " | " << ch.getValue() << endl;
 
-        L3Address node_addr = ch.getIpAddress();
-        if ((node_addr != loopbackAddress) && (node_addr != myAddress)) {
-            int tmp_num_hops = 100000;
-            L3Address tmp_nextHop_address = L3Address();
+        const L3Address& node_addr = ch.getIpAddress();
+        if ((node_addr == loopbackAddress) || (node_addr == myAddress))
+            continue;
 
+        // changes of the same node usually come in a row
+        int slot = (lastSlot >= 0 && nodeTable.getAddress(lastSlot) == node_addr) ? lastSlot : nodeTable.find(node_addr);
+        if (slot < 0) {
+            //new node
             NodeData nd;
-            if (nodeDataMap.count(node_addr) != 1) {
-                //new node
-                nd.timestamp = payload->getTimestamp();
-                nd.sequenceNumber = ch.getSequenceNumber();
-                nd.address = node_addr;
-                nd.coord_x = 0;
-                nd.coord_y = 0;
-                nd.memoryActUsage = 0;
-                nd.memoryMaxUsage = 0;
-                nd.compActUsage = 0;
-                nd.compMaxUsage = 0;
-                nd.hasCamera = false;
-                nd.lockedCamera = false;
-                nd.hasGPU = false;
-                nd.lockedGPU = false;
-                nd.lockedFly = false;
-                nd.nextHop_address = ch.getNextHop_address();
-                nd.num_hops = ch.getHops() + 1;
-                nodeDataMap[node_addr] = nd;
-                for (int j=0; j<16; j++) nd.lastSeqNumber[j] = 0;
-            } else {
-                nd = nodeDataMap[node_addr];
-            }
+            nd.timestamp = payload->getTimestamp();
+            nd.sequenceNumber = ch.getSequenceNumber();
+            nd.address = node_addr;
+            nd.coord_x = 0;
+            nd.coord_y = 0;
+            nd.memoryActUsage = 0;
+            nd.memoryMaxUsage = 0;
+            nd.compActUsage = 0;
+            nd.compMaxUsage = 0;
+            nd.hasCamera = false;
+            nd.lockedCamera = false;
+            nd.hasGPU = false;
+            nd.lockedGPU = false;
+            nd.lockedFly = false;
+            nd.nextHop_address = ch.getNextHop_address();
+            nd.num_hops = ch.getHops() + 1;
+            nd.radius = 0;
+            for (int j=0; j<16; j++) nd.lastSeqNumber[j] = 0;
+            slot = nodeTable.upsert(node_addr, nd);
+        }
+        blockSlots.push_back(std::make_pair(slot, i));
+        lastSlot = slot;
+    }
+
+    // 2nd pass: apply the changes grouped per node, each entry is read and written once
+    std::sort(blockSlots.begin(), blockSlots.end());
+    for (size_t g = 0; g < blockSlots.size(); ) {
+        int slot = blockSlots[g].first;
+        NodeData nd = nodeTable.get(slot);
+        bool updated = false;
+
+        for (; g < blockSlots.size() && blockSlots[g].first == slot; ++g) {
+            const Change& ch = payload->getChangesList(blockSlots[g].second);
 
             //add sequence number verification
             if (nd.lastSeqNumber[ch.getParammeter()] < ch.getSequenceNumber()) {
@@ -2615,32 +2484,33 @@ void SimpleBroadcast1Hop::processChangesBlock(const Ptr<const ChangesBlock>paylo
                     break;
                 }
                 nd.lastSeqNumber[ch.getParammeter()] = ch.getSequenceNumber();
-                nodeDataMap[node_addr] = nd;
+                updated = true;
             }
-            addChange(ch);
         }
 
+        if (updated)
+            nodeTable.set(slot, nd);
     }
-    //EV_INFO << myAddress << " nodeDataMap size: " << nodeDataMap.size() << std::endl;
-}
 
-void SimpleBroadcast1Hop::addChange(Change ch){
-    bool cy = true;
-    for (int i=0; i<stChanges.size(); i++){
-        if (stChanges[i].getIpAddress() ==ch.getIpAddress() &&
-                stChanges[i].getParammeter() == ch.getParammeter()) {
-            cy = false;
-            if (ch.getSequenceNumber() > stChanges[i].getSequenceNumber() ) {
-                //update element
-                stChanges[i].setValue(ch.getValue());
-                stChanges[i].setSequenceNumber(ch.getSequenceNumber());
-            }
-        }
+    // the timeline of the sender, against its maxima as known here
+    int srcSlot = nodeTable.find(srcAddr);
+    if (srcSlot >= 0) {
+        readCapacityTimeline(*payload, nodeTable.compMaxUsage()[srcSlot], nodeTable.memoryMaxUsage()[srcSlot], timelineSteps);
+        nodeTable.setTimeline(srcSlot, timelineSteps);
     }
-    if (cy) {
-        //add element
-        stChanges.push_back(ch);
+
+    // relay queue, in block order
+    for (int i=0; i<payload->getChangesCount(); i++){
+        const Change& ch = payload->getChangesList(i);
+        if ((ch.getIpAddress() != loopbackAddress) && (ch.getIpAddress() != myAddress))
+            addChange(ch);
     }
+
+    //EV_INFO << myAddress << " nodeTable size: " << nodeTable.size() << std::endl;
+}
+
+void SimpleBroadcast1Hop::addChange(const Change& ch){
+    stChanges.merge(ch);
 }
 
 
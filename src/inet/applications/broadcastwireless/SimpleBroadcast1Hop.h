@@ -27,6 +27,8 @@
 #include <deque>
 
 #include <numeric>  // for std::accumulate
+#include <typeindex>
+#include <memory>
 #include <cmath>     // for std::sqrt, std::acos
 
 #include "inet/mobility/base/MovingMobilityBase.h"
@@ -35,6 +37,20 @@
 #include "inet/transportlayer/contract/udp/UdpSocket.h"
 #include "inet/networklayer/common/L3Address.h"
 
+#include "NodeTable.h"
+#include "DecisionCache.h"
+#include "DecisionEngine.h"
+#include "NeighbourAggregates.h"
+#include "ChangeQueue.h"
+#include "RelayFilter.h"
+#include "ResourceLedger.h"
+#include "DeploymentStatistics.h"
+#include "OrchestrationRegistry.h"
+#include "WarmupSnapshot.h"
+#include "InputLog.h"
+#include "ReplayMobility.h"
+#include "TraceRing.h"
+#include "VectorPool.h"
 #include "Heartbeat_m.h"
 #include "TaskREQ_m.h"
 
@@ -42,6 +58,9 @@ namespace inet {
 
 extern template class ClockUserModuleMixin<ApplicationBase>;
 
+// tasks are immutable once created, and shared by the queues and task lists holding them
+typedef std::shared_ptr<const TaskREQ> TaskPtr;
+
 enum idField : uint8_t { //Field Id for Aggregated net info
     fldActCPU,
     fldMaxCPU,
@@ -63,37 +82,10 @@ enum idField : uint8_t { //Field Id for Aggregated net info
 /**
  * UDP application. See NED for more info.
  */
-class INET_API SimpleBroadcast1Hop : public ClockUserModuleMixin<ApplicationBase>, public UdpSocket::ICallback
+class INET_API SimpleBroadcast1Hop : public ClockUserModuleMixin<ApplicationBase>, public UdpSocket::ICallback, public IOrchestrationMember, public ISnapshotMember
 {
 public:
-    struct NodeData
-    {
-        simtime_t timestamp;
-        int sequenceNumber;
-        L3Address address;
-        double coord_x;
-        double coord_y;
-        double memoryActUsage;
-        double memoryMaxUsage;
-        double compActUsage;
-        double compMaxUsage;
-
-        bool hasCamera;
-        bool lockedCamera;
-
-        bool hasGPU;
-        bool lockedGPU;
-
-        bool lockedFly;
-
-        double radius; //for partial net info
-        uint32_t lastSeqNumber[16]; //last received sequence number for each field - Changes Approach
-
-        L3Address nextHop_address;
-        int num_hops;
-
-        // Add other fields as needed
-    };
+    typedef inet::NodeData NodeData;
 
     struct Task_generated_extra_info
     {
@@ -102,14 +94,6 @@ public:
         std::vector<L3Address> decision_nodes_at_generation;
     };
 
-    struct Task_deploy_extra_info
-    {
-        simtime_t deploy_time;
-        double node_pos_coord_x;
-        double node_pos_coord_y;
-        int deploy_hops;
-    };
-
     /*struct Task
     {
         L3Address gen_address;
@@ -129,23 +113,6 @@ public:
         bool req_lock_flyengine;
     };*/
 
-    struct Task_Deployed_stat_info
-    {
-        simtime_t deploy_time;
-        L3Address add_deploy_node;
-        double node_pos_coord_x;
-        double node_pos_coord_y;
-        int num_hops_to_deploy;
-    };
-    struct Task_Generated_stat_info
-    {
-        simtime_t generation_time;
-        L3Address gen_address;
-        uint32_t id_task;
-        Strategy strategy;
-        std::vector<Task_Deployed_stat_info> extra_info;
-    };
-
   protected:
     enum SelfMsgKinds { START = 1, SEND, STOP };
     enum TaskMsgKinds { NEW_T = 1 };
@@ -153,6 +120,14 @@ public:
     enum TaskAckMsgKinds { ACK_CHECK = 1 };
 
     enum DisseminationType { HIERARCHICAL = 1, PROGRESSIVE = 2, HIERARCHICAL_CHANGES = 3 };
+    enum InitialTableMode { TABLE_CONVERGENT, TABLE_ORACLE };
+    // trace ring record types; tasks are recorded as (generator, task id, peer or count)
+    enum TraceEvent : uint8_t {
+        TRACE_HEARTBEAT_SENT, TRACE_HEARTBEAT_RECEIVED, TRACE_CHANGES_SENT, TRACE_CHANGES_RECEIVED,
+        TRACE_TASK_SENT, TRACE_TASK_RECEIVED, TRACE_ACK_SENT, TRACE_ACK_RECEIVED, TRACE_ACK_EXPIRED,
+        TRACE_TASK_DEPLOYED, TRACE_DECISION, NUM_TRACE_EVENTS
+    };
+    static const char *const traceEventNames[NUM_TRACE_EVENTS];
     //enum StrategyType { STRATEGY_FORALL = 1, STRATEGY_EXISTS = 2};
 
     // parameters
@@ -172,21 +147,51 @@ public:
     double radius; //for Aggregated net info
 
     double startMakingStats = 0;
+    InitialTableMode initialTableMode = TABLE_CONVERGENT;
 
     NodeInfo lastReport; // for Changes approach
-    std::deque<Change> stChanges; // for Changes approach
+    ChangeQueue stChanges; // for Changes approach
+    std::vector<std::pair<int, int>> blockSlots; // scratch (slot, change index) of processChangesBlock
 
 
     // state
     UdpSocket socket;
     ClockEvent *selfMsg = nullptr;
+    bool resumed = false; // continues a warm-up snapshot: the first heartbeat is sent after resumeSendDelay
+    simtime_t resumeSendDelay;
 
 
 
-    std::map<L3Address, NodeData> nodeDataMap;
+    NodeTable nodeTable;
+    NeighbourAggregates neighbourAggregates; // PROGRESSIVE heartbeat metrics and radius, fed by nodeTable in PROGRESSIVE only
+    DecisionCache decisionCache; // placement decisions over nodeTable, per requirement signature
+    NodeTable decisionTable; // this node and the nodes with a timeline at their peak load, rebuilt by checkDeployDestination
+    std::vector<uint64_t> feasibleMask; // scratch output of CandidateEvaluator
+    std::vector<double> candidateScores; // scratch output of CandidateEvaluator
+    std::vector<double> slotScores; // scratch, progressive scores of the cached candidates by slot
+    std::vector<int> slotsInCircle; // scratch, cached candidates within the task range
     //std::map<std::pair<L3Address, uint32_t>, bool> relayMap;
 
-    std::set<std::pair<L3Address, uint32_t>> relayedPackets;
+    RelayFilter relayFilter; // tasks already relayed, per generator
+    int capacityTimelineSteps = 4;
+    std::vector<std::pair<double, ReservationCalendar::Load>> upcomingLoad; // scratch of getMyTimeline
+    std::vector<LoadStep> timelineSteps; // scratch, timeline of a payload being written or read
+
+    InputLogWriter inputLog; // received payloads and moves, see inputLogFile
+
+    // replay of an input log instead of the socket, see replayFile
+    bool replaying = false;
+    InputLogReader replayLog;
+    InputLogRecord replayRecord; // next to be replayed
+    cMessage *replayMsg = nullptr;
+    ReplayMobility *replayMobility = nullptr;
+
+    TraceRing traceRing; // last hot-path events, dumped at finish() or on error
+    std::string traceRingFile;
+    bool traceDumped = false;
+
+    typedef void (*PacketHandler)(SimpleBroadcast1Hop *self, const Ptr<const Chunk>& chunk, L3Address srcAddr, L3Address destAddr);
+    std::unordered_map<std::type_index, PacketHandler> packetHandlers; // by payload chunk type
     //std::set<std::tuple<L3Address, uint32_t, uint32_t>> relayedPackets;
 
     // Task Generation
@@ -198,23 +203,39 @@ public:
     double stddev_tf = 0.0002;
     double maxForwardDelay = 0.001;
     struct Forwarding_Task {
-        std::vector<L3Address> dests;
-        TaskREQ task;
-        std::vector<int> ttls;
+        std::vector<L3Address> dests;   // from destPool
+        TaskPtr task;
+        std::vector<int> ttls;          // from ttlPool
         uint numberOfSending;
     };
     std::queue<Forwarding_Task> forwardingTask_queue;
+    VectorPool<L3Address> destPool;
+    VectorPool<int> ttlPool;
+    std::vector<std::tuple<L3Address, L3Address, int>> destNextTtl; // scratch of sendTaskTo
 
     ClockEvent *taskAckMsg = nullptr;
     uint numberOfMaxRetry = 1;
     double ackTimer = 3.0*maxForwardDelay;
     struct Ack_Forwarding_Task {
-        Forwarding_Task ft;
-        std::vector<L3Address> non_ack_dests;
-        std::vector<int> non_ack_ttls;
+        Forwarding_Task ft;         // ft.dests/ft.ttls are the destinations waiting for the ACK
+        std::vector<bool> acked;    // per destination of ft
+        int numPending;
         simtime_t sendingTimestamp;
     };
-    std::vector<Ack_Forwarding_Task> ackVector;
+    struct AckKey {
+        L3Address gen;
+        uint32_t id;
+        L3Address dest;
+        bool operator==(const AckKey& o) const { return id == o.id && gen == o.gen && dest == o.dest; }
+    };
+    struct AckKeyHash {
+        size_t operator()(const AckKey& k) const { return (L3AddressHash()(k.gen) * 31 + k.id) * 31 + L3AddressHash()(k.dest); }
+    };
+    typedef std::pair<simtime_t, long> AckDeadline; // (deadline, entry id)
+    long nextAckEntryId = 0;
+    std::unordered_map<long, Ack_Forwarding_Task> ackEntries;
+    std::unordered_map<AckKey, std::vector<std::pair<long, int>>, AckKeyHash> ackIndex; // -> (entry id, destination index)
+    std::priority_queue<AckDeadline, std::vector<AckDeadline>, std::greater<AckDeadline>> ackDeadlines;
 
     // statistics
     int numTaskCreated = 0;
@@ -228,6 +249,7 @@ public:
 
     int netPktSent_beforeStart = 0;
     long netPktSize_beforeStart = 0;
+    void countInfoPacket(uint32_t size);
 
 
 
@@ -241,6 +263,10 @@ public:
 
 
     //static simsignal_t taskDeploymentTimeSignal;   // to record times
+    static simsignal_t taskGeneratedSignal;   // task events for DeploymentStatistics
+    static simsignal_t taskDeployedSignal;
+    static simsignal_t taskAckedSignal;
+    static simsignal_t infoPacketSentSignal;
 
 public:
 
@@ -248,18 +274,35 @@ public:
     L3Address myAddress;
     int myAppAddr;
 
-    std::vector<TaskREQ> assignedTask_list; //list of assigned task
-    std::map<std::pair<L3Address, uint32_t>, Task_deploy_extra_info> extra_info_deploy_tasks;
+    ResourceLedger resourceLedger; // usage of the assigned tasks; the statistics are collected by DeploymentStatistics
+    int taskRng = 0;        // RNGs of the random draws, see NED
+    int forwardingRng = 0;
+    int placementRng = 0;
+    PlacementPolicy placementPolicy; // gamma and arc of the placement, see DecisionEngine
 
     //std::vector<std::pair<TaskREQ, simtime_t>> generatedTask_list; //list of assigned task
-    std::vector<TaskREQ> generatedTask_list; //list of assigned task
-    std::map<std::pair<L3Address, uint32_t>, Task_generated_extra_info> extra_info_generated_tasks;
 
     virtual NodeData getMyNodeData();
+    /** getMyNodeData() with the peak usage and locks over the lifetime of the task. */
+    virtual NodeData getMyNodeDataFor(const TaskREQ& task);
+    /** The usage steps of the local reservations after now, at most capacityTimelineSteps. */
+    virtual void getMyTimeline(std::vector<LoadStep>& out);
+    /** The usage and locks advertised by a PROGRESSIVE heartbeat when this node has the given ones. */
+    LoadStep foldNeighbourAggregates(const LoadStep& own) const;
+
+    OrchestrationRegistry *registry = nullptr; // optional, see the registryModule parameter
+    virtual void applyPeakLoad(simtime_t start, simtime_t end, NodeData& state) override;
+
+    WarmupSnapshot *snapshot = nullptr; // optional, see the snapshotModule parameter
+    virtual void saveSnapshot(SnapshotWriter& w) override;
+    virtual void loadSnapshot(SnapshotReader& r, simtime_t warmupTime) override;
+    /** Hash of the parameters that shape the warm-up, stored in the snapshot. */
+    uint64_t getWarmupParamsHash();
 
   protected:
     virtual int numInitStages() const override { return NUM_INIT_STAGES; }
     virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
     virtual void handleMessageWhenUp(cMessage *msg) override;
     virtual void finish() override;
     virtual void refreshDisplay() const override;
@@ -270,8 +313,17 @@ public:
     virtual void printPacket(Packet *msg);
     virtual void processPacket(Packet *msg);
     virtual void setSocketOptions();
-
+    /** Sends the packet through the socket; it is dropped when replaying. */
+    virtual void sendToSocket(Packet *packet, const L3Address& destAddr);
+    virtual void scheduleNextReplay();
+    virtual void processReplay();
+
+    template<typename T, void (SimpleBroadcast1Hop::*process)(const Ptr<const T>, L3Address, L3Address)>
+    static void dispatch(SimpleBroadcast1Hop *self, const Ptr<const Chunk>& chunk, L3Address srcAddr, L3Address destAddr);
+    virtual void registerPacketHandlers();
     virtual void processHeartbeat(const Ptr<const Heartbeat> payload, L3Address srcAddr, L3Address destAddr);
+    /** Merges the node list of a HIERARCHICAL heartbeat into the table; returns the number of entries changed. */
+    virtual int mergeNodeInfoList(const Heartbeat& payload);
     virtual Ptr<Heartbeat> createPayload();
     virtual void processStart();
     virtual void processSend();
@@ -279,32 +331,46 @@ public:
 
     //for Changes Approach
     virtual void processChangesBlock(const Ptr<const ChangesBlock> payload, L3Address srcAddr, L3Address destAddr);
-    virtual void addChange(Change ch);
+    virtual void addChange(const Change& ch);
     virtual Ptr<ChangesBlock> createChangesPayload();
 
 
 
     //virtual Ptr<TaskREQmessage> createPayloadForTask(L3Address& finaldest, L3Address& nexthopdest, TaskREQ& task, int ttl);
-    virtual Ptr<TaskREQmessage> createPayloadForTask(std::vector<std::tuple<L3Address, L3Address, int>>& finaldest_next_ttl, TaskREQ& task);
+    virtual Ptr<TaskREQmessage> createPayloadForTask(const std::vector<std::tuple<L3Address, L3Address, int>>& finaldest_next_ttl, const TaskREQ& task);
 
     virtual TaskREQ parseTask();
-    virtual bool isDeployFeasibleLocal(TaskREQ& task);
-    virtual bool isDeployFeasible(TaskREQ& task, NodeData node);
-    virtual std::vector<L3Address> checkDeployDestinationAmong_Progressive(TaskREQ& task, std::map<L3Address, NodeData>& nodes);
-    virtual std::vector<L3Address> checkDeployDestinationAmong(TaskREQ& task, std::map<L3Address, NodeData>& nodes);
-    virtual std::vector<L3Address> checkDeployDestination(TaskREQ& task, L3Address avoidAddress = L3Address("0.0.0.0"));
-    virtual void sendTaskTo(std::vector<L3Address>& dest, TaskREQ& task, std::vector<int>& ttl);
-    virtual void deployTaskHere(TaskREQ& task);
-    virtual void manageNewTask(TaskREQ& task, bool generatedHereNow = false, L3Address avoidAddress = L3Address("0.0.0.0"));
+    virtual bool isDeployFeasibleLocal(const TaskREQ& task);
+    virtual bool isDeployFeasible(const TaskREQ& task, const NodeData& node);
+    virtual std::vector<L3Address> checkDeployDestinationAmong_Progressive(const TaskREQ& task, const std::vector<std::pair<L3Address, double>>& candidates);
+    virtual std::vector<L3Address> checkDeployDestinationAmong(const TaskREQ& task, const std::vector<L3Address>& nodeDataMap_feasible);
+    virtual std::vector<L3Address> checkDeployDestination(const TaskREQ& task, L3Address avoidAddress = L3Address("0.0.0.0"));
+    virtual void sendTaskTo(const std::vector<L3Address>& dest, const TaskREQ& task, const std::vector<int>& ttl);
+    virtual void deployTaskHere(const TaskPtr& task);
+    virtual void manageNewTask(const TaskPtr& task, bool generatedHereNow = false, L3Address avoidAddress = L3Address("0.0.0.0"));
+    virtual void enqueueForwarding(const TaskPtr& task, std::vector<L3Address>& dests, std::vector<int>& ttls, uint numberOfSending = 0);
+    void releaseForwarding(Forwarding_Task& ft) { destPool.release(ft.dests); ttlPool.release(ft.ttls); ft.task.reset(); }
     virtual void generateNewTask();
     virtual void processTaskREQmessage(const Ptr<const TaskREQmessage>payload, L3Address srcAddr, L3Address destAddr);
     virtual void processTaskREQ_ACKmessage(const Ptr<const TaskREQ_ACKmessage>payload, L3Address srcAddr, L3Address destAddr);
 
-    virtual double calculateProgressiveScore(TaskREQ& task, NodeData node);
+    virtual double calculateProgressiveScore(const TaskREQ& task, const NodeData& node);
 
     virtual void forwardTask();
     virtual void ackTask();
+    virtual void rescheduleAckTimer();
     virtual void updateRadius();
+    /** Throws if a module other than the applications draws from the task, forwarding or placement RNG (inputLogFile). */
+    virtual void checkRngIsolation(cModule *mod) const;
+    /** Fills the node table with the converged state computed from the registry (initialTableMode = "oracle"). */
+    virtual void fillOracleTable();
+
+    static uint32_t traceId(const L3Address& addr) { return addr.getType() == L3Address::IPv4 ? addr.toIpv4().getInt() : 0; }
+    void trace(TraceEvent type, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+        if (traceRing.isEnabled())
+            traceRing.record(type, simTime().dbl(), a, b, c);
+    }
+    virtual void dumpTrace(const char *reason);
 
     virtual void handleStartOperation(LifecycleOperation *operation) override;
     virtual void handleStopOperation(LifecycleOperation *operation) override;
@@ -321,33 +387,6 @@ public:
     static bool isWithinArc(double xa, double ya, double xb, double yb, double xd, double yd, double alphaDegrees);
 };
 
-// Correctly overload operator<< as a non-member function
-inline std::ostream& operator<<(std::ostream& os, const SimpleBroadcast1Hop::NodeData& data)
-{
-    os << "{ sequenceNumber: " << data.sequenceNumber
-            << ", address: " << data.address
-            << ", timestamp: " << data.timestamp
-            << ", coord_x: " << data.coord_x
-            << ", coord_y: " << data.coord_y
-            << ", memoryActUsage: " << data.memoryActUsage
-            << ", memoryMaxUsage: " << data.memoryMaxUsage
-            << ", compActUsage: " << data.compActUsage
-            << ", compMaxUsage: " << data.compMaxUsage
-            << ", hasGPU: " << data.hasGPU
-            << ", lockedGPU: " << data.lockedGPU
-            << ", hasCamera: " << data.hasCamera
-            << ", lockedCamera: " << data.lockedCamera
-            << ", lockedFly: " << data.lockedFly
-            << " ||| nextHop_address: " << data.nextHop_address
-            << ", num_hops: " << data.num_hops
-            << ", radius: " << data.radius
-            << ", lastSeqNumber: ";
-            for (int i=0; i<16; i++) os << data.lastSeqNumber[i] << ","; //for Changes approach
-            os << " }";
-
-    return os;
-}
-
 // Correctly overload operator<< as a non-member function
 inline std::ostream& operator<<(std::ostream& os, const inet::TaskREQ& data)
 {
@@ -373,6 +412,11 @@ inline std::ostream& operator<<(std::ostream& os, const inet::TaskREQ& data)
     return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os, const inet::TaskPtr& data)
+{
+    return os << *data;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const std::tuple<L3Address, uint32_t, uint32_t>& data)
 {
     os << "{ addr: " << std::get<0>(data)
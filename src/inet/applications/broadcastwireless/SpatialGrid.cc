@@ -0,0 +1,112 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#include "SpatialGrid.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace inet {
+
+const int64_t SpatialGrid::NO_CELL;
+
+void SpatialGrid::setCellSize(double size)
+{
+    cellSize = size;
+    clear();
+}
+
+void SpatialGrid::clear()
+{
+    cells.clear();
+    cellOf.clear();
+    posInCell.clear();
+}
+
+int64_t SpatialGrid::cellIndex(double v) const
+{
+    return (int64_t)std::floor(v / cellSize);
+}
+
+void SpatialGrid::removeFromCell(int slot)
+{
+    auto it = cells.find(cellOf[slot]);
+    std::vector<int>& members = it->second;
+    int pos = posInCell[slot];
+    int last = members.back();
+    members[pos] = last;
+    posInCell[last] = pos;
+    members.pop_back();
+    if (members.empty())
+        cells.erase(it);
+    cellOf[slot] = NO_CELL;
+}
+
+void SpatialGrid::update(int slot, double x, double y)
+{
+    if (!isEnabled())
+        return;
+
+    if (slot >= (int)cellOf.size()) {
+        cellOf.resize(slot + 1, NO_CELL);
+        posInCell.resize(slot + 1, -1);
+    }
+
+    int64_t key = cellKey(cellIndex(x), cellIndex(y));
+    if (cellOf[slot] == key)
+        return;
+
+    if (cellOf[slot] != NO_CELL)
+        removeFromCell(slot);
+
+    std::vector<int>& members = cells[key];
+    posInCell[slot] = members.size();
+    members.push_back(slot);
+    cellOf[slot] = key;
+}
+
+void SpatialGrid::remove(int slot)
+{
+    if (slot < (int)cellOf.size() && cellOf[slot] != NO_CELL)
+        removeFromCell(slot);
+}
+
+void SpatialGrid::queryCircle(double x, double y, double r, std::vector<int>& out) const
+{
+    int64_t ix0 = cellIndex(x - r), ix1 = cellIndex(x + r);
+    int64_t iy0 = cellIndex(y - r), iy1 = cellIndex(y + r);
+
+    // a circle much larger than the populated area: visiting the occupied cells is cheaper
+    if ((double)(ix1 - ix0 + 1) * (double)(iy1 - iy0 + 1) > (double)cells.size()) {
+        for (auto& cell : cells)
+            out.insert(out.end(), cell.second.begin(), cell.second.end());
+        return;
+    }
+
+    for (int64_t ix = ix0; ix <= ix1; ++ix) {
+        // closest x of this column of cells to the circle centre
+        double nx = std::max(ix * cellSize, std::min(x, (ix + 1) * cellSize));
+        for (int64_t iy = iy0; iy <= iy1; ++iy) {
+            double ny = std::max(iy * cellSize, std::min(y, (iy + 1) * cellSize));
+            if ((nx - x) * (nx - x) + (ny - y) * (ny - y) > r * r)
+                continue;
+            auto it = cells.find(cellKey(ix, iy));
+            if (it != cells.end())
+                out.insert(out.end(), it->second.begin(), it->second.end());
+        }
+    }
+}
+
+} // namespace inet
@@ -0,0 +1,64 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_SPATIALGRID_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_SPATIALGRID_H_
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace inet {
+
+/**
+ * Uniform grid over the node table coordinates, indexed by slot.
+ * Only occupied cells are stored, so the covered area is unbounded.
+ */
+class SpatialGrid
+{
+  protected:
+    double cellSize = 0;
+    std::unordered_map<int64_t, std::vector<int>> cells;
+    static const int64_t NO_CELL = INT64_MIN;
+    std::vector<int64_t> cellOf;   // per slot, NO_CELL if not in the grid
+    std::vector<int> posInCell;    // per slot, index inside its cell vector
+
+    int64_t cellIndex(double v) const;
+    static int64_t cellKey(int64_t ix, int64_t iy) { return (int64_t)(((uint64_t)ix << 32) ^ ((uint64_t)iy & 0xffffffffULL)); }
+    void removeFromCell(int slot);
+
+  public:
+    SpatialGrid() {}
+
+    bool isEnabled() const { return cellSize > 0; }
+    double getCellSize() const { return cellSize; }
+    /** Sets the cell size (0 disables the grid) and empties it. */
+    void setCellSize(double size);
+    void clear();
+
+    /** Inserts the slot, or moves it if its cell changed. */
+    void update(int slot, double x, double y);
+    void remove(int slot);
+
+    /**
+     * Appends to out the slots of all cells overlapping the circle. The result
+     * is a superset of the slots inside the circle, in no particular order.
+     */
+    void queryCircle(double x, double y, double r, std::vector<int>& out) const;
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_SPATIALGRID_H_ */
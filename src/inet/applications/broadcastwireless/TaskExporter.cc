@@ -0,0 +1,130 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "TaskExporter.h"
+
+#include <cstdarg>
+#include <algorithm>
+
+#include "inet/common/INETUtils.h"
+
+namespace inet {
+
+TaskExporter::~TaskExporter()
+{
+    // only left open when the simulation ends with an error: write what is there, without throwing
+    for (Output *out : { &tasks, &deployments }) {
+        if (out->f != nullptr) {
+            fwrite(out->buffer.data(), 1, out->buffer.size(), out->f);
+            fclose(out->f);
+        }
+    }
+}
+
+void TaskExporter::open(const std::string& baseName, size_t blockSize)
+{
+    close();
+    this->blockSize = blockSize;
+    open(tasks, baseName + ".tasks.csv",
+            "gen_address,id_task,strategy,generation_time,num_deployable,deployable_nodes,num_decision,decision_nodes");
+    open(deployments, baseName + ".deployments.csv",
+            "gen_address,id_task,add_deploy_node,deploy_time,node_pos_coord_x,node_pos_coord_y,num_hops_to_deploy");
+}
+
+void TaskExporter::open(Output& out, const std::string& fileName, const char *header)
+{
+    inet::utils::makePathForFile(fileName.c_str());
+    out.fileName = fileName;
+    out.f = fopen(fileName.c_str(), "w");
+    if (out.f == nullptr)
+        throw cRuntimeError("Cannot open task export file '%s'", fileName.c_str());
+    out.buffer.reserve(blockSize + 4096);
+    out.buffer.append(header);
+    endRow(out);
+}
+
+void TaskExporter::flush(Output& out)
+{
+    if (out.buffer.empty())
+        return;
+    if (fwrite(out.buffer.data(), 1, out.buffer.size(), out.f) != out.buffer.size())
+        throw cRuntimeError("Error writing task export file '%s'", out.fileName.c_str());
+    out.buffer.clear();
+}
+
+void TaskExporter::close(Output& out)
+{
+    if (out.f == nullptr)
+        return;
+    flush(out);
+    bool ok = fclose(out.f) == 0;
+    out.f = nullptr;
+    if (!ok)
+        throw cRuntimeError("Error closing task export file '%s'", out.fileName.c_str());
+}
+
+void TaskExporter::close()
+{
+    close(tasks);
+    close(deployments);
+}
+
+void TaskExporter::appendf(Output& out, const char *fmt, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n > 0)
+        out.buffer.append(buf, std::min<size_t>(n, sizeof(buf) - 1));
+}
+
+void TaskExporter::appendNodes(Output& out, const std::vector<L3Address>& nodes)
+{
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (i > 0)
+            out.buffer.push_back(' ');
+        out.buffer.append(nodes[i].str());
+    }
+}
+
+void TaskExporter::endRow(Output& out)
+{
+    out.buffer.push_back('\n');
+    if (out.buffer.size() >= blockSize)
+        flush(out);
+}
+
+void TaskExporter::writeTask(const Task_Generated_stat_info& task, const std::vector<L3Address>& deployableNodes, const std::vector<L3Address>& decisionNodes)
+{
+    appendf(tasks, "%s,%u,%d,%s,%zu,", task.gen_address.str().c_str(), task.id_task, (int)task.strategy,
+            task.generation_time.str().c_str(), deployableNodes.size());
+    appendNodes(tasks, deployableNodes);
+    appendf(tasks, ",%zu,", decisionNodes.size());
+    appendNodes(tasks, decisionNodes);
+    endRow(tasks);
+}
+
+void TaskExporter::writeDeployment(const Task_Generated_stat_info& task, const Task_Deployed_stat_info& deployment)
+{
+    appendf(deployments, "%s,%u,%s,%s,%.17g,%.17g,%d", task.gen_address.str().c_str(), task.id_task,
+            deployment.add_deploy_node.str().c_str(), deployment.deploy_time.str().c_str(),
+            deployment.node_pos_coord_x, deployment.node_pos_coord_y, deployment.num_hops_to_deploy);
+    endRow(deployments);
+}
+
+} // namespace inet
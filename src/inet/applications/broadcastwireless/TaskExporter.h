@@ -0,0 +1,72 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_TASKEXPORTER_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_TASKEXPORTER_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "DeploymentStatistics.h"
+
+namespace inet {
+
+/**
+ * Writes the task records of DeploymentStatistics as two CSV files,
+ * <base>.tasks.csv (one row per generated task) and <base>.deployments.csv
+ * (one row per deployment). The columns follow Task_Generated_stat_info and
+ * Task_Deployed_stat_info; node lists are space separated in one column.
+ *
+ * Rows are appended to an in-memory block which is written out when it
+ * exceeds the block size, so the files are written in a few large writes.
+ */
+class INET_API TaskExporter
+{
+  protected:
+    struct Output
+    {
+        std::string fileName;
+        FILE *f = nullptr;
+        std::string buffer;
+    };
+
+    Output tasks;
+    Output deployments;
+    size_t blockSize = 1 << 20;
+
+    void open(Output& out, const std::string& fileName, const char *header);
+    void flush(Output& out);
+    void close(Output& out);
+    void appendf(Output& out, const char *fmt, ...);
+    void appendNodes(Output& out, const std::vector<L3Address>& nodes);
+    void endRow(Output& out);
+
+  public:
+    TaskExporter() {}
+    ~TaskExporter();
+
+    void open(const std::string& baseName, size_t blockSize);
+    bool isOpen() const { return tasks.f != nullptr; }
+    void close();
+
+    void writeTask(const Task_Generated_stat_info& task, const std::vector<L3Address>& deployableNodes, const std::vector<L3Address>& decisionNodes);
+    void writeDeployment(const Task_Generated_stat_info& task, const Task_Deployed_stat_info& deployment);
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_TASKEXPORTER_H_ */
@@ -0,0 +1,71 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "TraceRing.h"
+
+namespace inet {
+
+const uint32_t TraceRing::MAGIC;
+const uint32_t TraceRing::VERSION;
+
+void TraceRing::setCapacity(size_t capacity)
+{
+    records.assign(capacity, TraceRecord());
+    clear();
+}
+
+const TraceRecord& TraceRing::at(size_t i) const
+{
+    size_t first = total < records.size() ? 0 : next;
+    size_t pos = first + i;
+    if (pos >= records.size())
+        pos -= records.size();
+    return records[pos];
+}
+
+bool TraceRing::writeBinary(FILE *f) const
+{
+    uint32_t header[2] = { MAGIC, VERSION };
+    uint64_t counts[2] = { size(), total };
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1 && fwrite(counts, sizeof(counts), 1, f) == 1;
+
+    // packed, so the file layout does not depend on the struct padding
+    for (size_t i = 0; ok && i < size(); ++i) {
+        const TraceRecord& r = at(i);
+        ok = fwrite(&r.time, sizeof(r.time), 1, f) == 1
+                && fwrite(&r.a, sizeof(r.a), 1, f) == 1
+                && fwrite(&r.b, sizeof(r.b), 1, f) == 1
+                && fwrite(&r.c, sizeof(r.c), 1, f) == 1
+                && fwrite(&r.type, sizeof(r.type), 1, f) == 1;
+    }
+    return ok;
+}
+
+void TraceRing::writeText(std::ostream& os, const char *const *typeNames, int numTypeNames) const
+{
+    os << size() << " of " << total << " trace records\n";
+    for (size_t i = 0; i < size(); ++i) {
+        const TraceRecord& r = at(i);
+        os << r.time << " ";
+        if (typeNames != nullptr && r.type < numTypeNames)
+            os << typeNames[r.type];
+        else
+            os << (int)r.type;
+        os << " " << r.a << " " << r.b << " " << r.c << "\n";
+    }
+}
+
+} // namespace inet
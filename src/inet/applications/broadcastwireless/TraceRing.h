@@ -0,0 +1,87 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_TRACERING_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_TRACERING_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+namespace inet {
+
+/**
+ * Fixed-size record of a hot-path event: what happened, when, and up to
+ * three ids (addresses as IPv4 integers, task ids, counters).
+ */
+struct TraceRecord
+{
+    double time;
+    uint32_t a, b, c;
+    uint8_t type;
+};
+
+/**
+ * Ring buffer of the last N trace records. Recording is a couple of stores,
+ * nothing is formatted until the ring is dumped. A capacity of 0 disables it.
+ */
+class TraceRing
+{
+  protected:
+    std::vector<TraceRecord> records;
+    size_t next = 0;     // position of the next record
+    uint64_t total = 0;  // records ever written, including overwritten ones
+
+  public:
+    static const uint32_t MAGIC = 0x42575452; // "BWTR"
+    static const uint32_t VERSION = 1;
+
+    TraceRing() {}
+
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const { return records.size(); }
+    bool isEnabled() const { return !records.empty(); }
+    void clear() { next = 0; total = 0; }
+
+    void record(uint8_t type, double time, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+        if (records.empty())
+            return;
+        TraceRecord& r = records[next];
+        r.time = time; r.a = a; r.b = b; r.c = c; r.type = type;
+        if (++next == records.size())
+            next = 0;
+        ++total;
+    }
+
+    /** Number of records held, at most the capacity. */
+    size_t size() const { return total < records.size() ? (size_t)total : records.size(); }
+    uint64_t getTotal() const { return total; }
+    /** The i-th record held, oldest first. */
+    const TraceRecord& at(size_t i) const;
+
+    /**
+     * Writes a header (magic, version, record count, total) followed by the
+     * records oldest first, packed field by field in host byte order.
+     */
+    bool writeBinary(FILE *f) const;
+    /** One line per record; typeNames, if given, is indexed by record type. */
+    void writeText(std::ostream& os, const char *const *typeNames = nullptr, int numTypeNames = 0) const;
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_TRACERING_H_ */
@@ -0,0 +1,67 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_VECTORPOOL_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_VECTORPOOL_H_
+
+#include <vector>
+
+// NOTE: this file must not depend on OMNeT++/INET headers, it is also built by bench/
+
+namespace inet {
+
+/**
+ * Free list of emptied vectors that keep their capacity, so that short-lived
+ * per-task vectors stop allocating once the pool has warmed up.
+ */
+template<typename T>
+class VectorPool
+{
+  protected:
+    std::vector<std::vector<T>> free;
+    size_t maxFree;
+
+  public:
+    explicit VectorPool(size_t maxFree = 64) : maxFree(maxFree) {}
+
+    /** Returns an empty vector, with some capacity if one was released before. */
+    std::vector<T> acquire() {
+        if (free.empty())
+            return std::vector<T>();
+        std::vector<T> v = std::move(free.back());
+        free.pop_back();
+        return v;
+    }
+
+    /** Takes back the storage of v, or frees it when the pool is full; v is left empty. */
+    void release(std::vector<T>& v) {
+        if (v.capacity() == 0)
+            return;
+        if (free.size() >= maxFree) {
+            std::vector<T>().swap(v);
+            return;
+        }
+        v.clear();
+        free.push_back(std::move(v));
+        v = std::vector<T>();
+    }
+
+    size_t size() const { return free.size(); }
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_VECTORPOOL_H_ */
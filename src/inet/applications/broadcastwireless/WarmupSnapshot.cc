@@ -0,0 +1,269 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#include "WarmupSnapshot.h"
+
+#include "inet/common/INETUtils.h"
+
+namespace inet {
+
+Define_Module(WarmupSnapshot);
+
+const uint32_t WarmupSnapshot::MAGIC;
+const uint32_t WarmupSnapshot::VERSION;
+
+void SnapshotWriter::writeString(const std::string& s)
+{
+    write<uint32_t>(s.size());
+    data.append(s);
+}
+
+void SnapshotWriter::writeNodeData(const NodeData& d)
+{
+    writeTime(d.timestamp);
+    write<int32_t>(d.sequenceNumber);
+    writeAddress(d.address);
+    write(d.coord_x);
+    write(d.coord_y);
+    write(d.memoryActUsage);
+    write(d.memoryMaxUsage);
+    write(d.compActUsage);
+    write(d.compMaxUsage);
+    write<uint8_t>(d.hasCamera);
+    write<uint8_t>(d.lockedCamera);
+    write<uint8_t>(d.hasGPU);
+    write<uint8_t>(d.lockedGPU);
+    write<uint8_t>(d.lockedFly);
+    write(d.radius);
+    for (int i = 0; i < 16; i++)
+        write(d.lastSeqNumber[i]);
+    writeAddress(d.nextHop_address);
+    write<int32_t>(d.num_hops);
+}
+
+void SnapshotReader::require(size_t n) const
+{
+    if (n > (size_t)(end - pos))
+        throw cRuntimeError("Truncated warm-up snapshot record");
+}
+
+std::string SnapshotReader::readString()
+{
+    uint32_t n = read<uint32_t>();
+    require(n);
+    std::string s(pos, n);
+    pos += n;
+    return s;
+}
+
+L3Address SnapshotReader::readAddress()
+{
+    std::string s = readString();
+    return s.empty() ? L3Address() : L3Address(s.c_str());
+}
+
+NodeData SnapshotReader::readNodeData()
+{
+    NodeData d;
+    d.timestamp = readTime();
+    d.sequenceNumber = read<int32_t>();
+    d.address = readAddress();
+    d.coord_x = read<double>();
+    d.coord_y = read<double>();
+    d.memoryActUsage = read<double>();
+    d.memoryMaxUsage = read<double>();
+    d.compActUsage = read<double>();
+    d.compMaxUsage = read<double>();
+    d.hasCamera = read<uint8_t>();
+    d.lockedCamera = read<uint8_t>();
+    d.hasGPU = read<uint8_t>();
+    d.lockedGPU = read<uint8_t>();
+    d.lockedFly = read<uint8_t>();
+    d.radius = read<double>();
+    for (int i = 0; i < 16; i++)
+        d.lastSeqNumber[i] = read<uint32_t>();
+    d.nextHop_address = readAddress();
+    d.num_hops = read<int32_t>();
+    return d;
+}
+
+WarmupSnapshot::~WarmupSnapshot()
+{
+    cancelAndDelete(timer);
+}
+
+void WarmupSnapshot::initialize(int stage)
+{
+    if (stage == INITSTAGE_LOCAL) {
+        saveFile = par("saveFile").stdstringValue();
+        loadFile = par("loadFile").stdstringValue();
+        if (!saveFile.empty() && !loadFile.empty())
+            throw cRuntimeError("saveFile and loadFile cannot be both set");
+        timer = new cMessage("snapshotTimer");
+
+        if (!saveFile.empty()) {
+            simtime_t saveTime = par("saveTime");
+            if (saveTime <= SIMTIME_ZERO)
+                throw cRuntimeError("Invalid saveTime parameter");
+            scheduleAt(saveTime, timer);
+        }
+        else if (!loadFile.empty()) {
+            load();
+            // before the mobility modules initialize their own position
+            presetPositions();
+            scheduleAt(simTime(), timer);
+        }
+    }
+}
+
+void WarmupSnapshot::handleMessage(cMessage *msg)
+{
+    if (!saveFile.empty()) {
+        save();
+        endSimulation();
+    }
+    else {
+        // all the nodes have registered by now
+        for (auto& entry : records)
+            if (!entry.second.restored)
+                throw cRuntimeError("Node %d of warm-up snapshot '%s' is not in the network", entry.first, loadFile.c_str());
+    }
+}
+
+std::string WarmupSnapshot::getSeedSet() const
+{
+    const char *seedSet = getEnvir()->getConfigEx()->getVariable(CFGVAR_SEEDSET);
+    return seedSet != nullptr ? seedSet : "";
+}
+
+void WarmupSnapshot::registerMember(int index, ISnapshotMember *member, IMobility *mobility)
+{
+    if (members.find(index) != members.end())
+        throw cRuntimeError("Node %d is already registered", index);
+    members[index] = Member{member, mobility};
+
+    if (!isLoading())
+        return;
+
+    auto it = records.find(index);
+    if (it == records.end())
+        throw cRuntimeError("Node %d is not in warm-up snapshot '%s'", index, loadFile.c_str());
+    Record& rec = it->second;
+
+    // e.g. a mobility model that ignores the initial position parameters
+    if (mobility->getCurrentPosition().distance(rec.position) > 1e-6)
+        EV_WARN << "Node " << index << " is at " << mobility->getCurrentPosition()
+                << " instead of the saved " << rec.position << endl;
+
+    SnapshotReader r(rec.data);
+    member->loadSnapshot(r, warmupTime);
+    if (!r.atEnd())
+        throw cRuntimeError("Warm-up snapshot record of node %d is longer than expected", index);
+    rec.restored = true;
+}
+
+void WarmupSnapshot::save()
+{
+    SnapshotWriter w;
+    w.write(MAGIC);
+    w.write(VERSION);
+    w.writeTime(simTime());
+    w.writeString(getSeedSet());
+    w.write<uint32_t>(members.size());
+    for (auto& entry : members) {
+        SnapshotWriter record;
+        entry.second.member->saveSnapshot(record);
+
+        std::string mobilityPath = check_and_cast<cModule *>(entry.second.mobility)->getFullPath();
+        Coord pos = entry.second.mobility->getCurrentPosition();
+        w.write<int32_t>(entry.first);
+        w.writeString(mobilityPath);
+        w.write(pos.x);
+        w.write(pos.y);
+        w.write(pos.z);
+        w.writeString(record.getData());
+    }
+
+    inet::utils::makePathForFile(saveFile.c_str());
+    FILE *f = fopen(saveFile.c_str(), "wb");
+    if (f == nullptr)
+        throw cRuntimeError("Cannot open warm-up snapshot file '%s'", saveFile.c_str());
+    const std::string& data = w.getData();
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok &= fclose(f) == 0;
+    if (!ok)
+        throw cRuntimeError("Error writing warm-up snapshot file '%s'", saveFile.c_str());
+
+    EV_INFO << "Saved the state of " << members.size() << " nodes at " << simTime() << " to " << saveFile << endl;
+}
+
+void WarmupSnapshot::load()
+{
+    FILE *f = fopen(loadFile.c_str(), "rb");
+    if (f == nullptr)
+        throw cRuntimeError("Cannot open warm-up snapshot file '%s'", loadFile.c_str());
+    std::string data;
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.append(buf, n);
+    fclose(f);
+
+    SnapshotReader r(data);
+    if (r.read<uint32_t>() != MAGIC || r.read<uint32_t>() != VERSION)
+        throw cRuntimeError("'%s' is not a warm-up snapshot of this version", loadFile.c_str());
+    warmupTime = r.readTime();
+    // the RNG streams restart from their seeds: with the seeds of the warm-up, they would draw it again
+    std::string seedSet = r.readString();
+    if (seedSet == getSeedSet())
+        throw cRuntimeError("Warm-up snapshot '%s' was made with seed set %s, the resumed run needs another one",
+                loadFile.c_str(), seedSet.c_str());
+    int warmupSeedSet = par("warmupSeedSet");
+    if (warmupSeedSet >= 0 && seedSet != std::to_string(warmupSeedSet))
+        throw cRuntimeError("Warm-up snapshot '%s' was made with seed set %s instead of %d",
+                loadFile.c_str(), seedSet.c_str(), warmupSeedSet);
+
+    uint32_t count = r.read<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        Record& rec = records[r.read<int32_t>()];
+        rec.mobilityPath = r.readString();
+        rec.position.x = r.read<double>();
+        rec.position.y = r.read<double>();
+        rec.position.z = r.read<double>();
+        rec.data = r.readString();
+    }
+    if (!r.atEnd())
+        throw cRuntimeError("Trailing data in warm-up snapshot '%s'", loadFile.c_str());
+
+    EV_INFO << "Loaded the state of " << records.size() << " nodes at " << warmupTime << " from " << loadFile << endl;
+}
+
+void WarmupSnapshot::presetPositions()
+{
+    for (auto& entry : records) {
+        const Record& rec = entry.second;
+        cModule *mobility = findModuleByPath(rec.mobilityPath.c_str());
+        if (mobility == nullptr || !mobility->hasPar("initialX"))
+            continue;
+        if (mobility->hasPar("initFromDisplayString"))
+            mobility->par("initFromDisplayString").setBoolValue(false);
+        mobility->par("initialX").setDoubleValue(rec.position.x);
+        mobility->par("initialY").setDoubleValue(rec.position.y);
+        mobility->par("initialZ").setDoubleValue(rec.position.z);
+    }
+}
+
+} // namespace inet
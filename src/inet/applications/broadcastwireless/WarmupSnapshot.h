@@ -0,0 +1,152 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef INET_APPLICATIONS_BROADCASTWIRELESS_WARMUPSNAPSHOT_H_
+#define INET_APPLICATIONS_BROADCASTWIRELESS_WARMUPSNAPSHOT_H_
+
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "inet/common/INETDefs.h"
+#include "inet/mobility/contract/IMobility.h"
+
+#include "NodeTable.h"
+
+namespace inet {
+
+/**
+ * Binary record of one member in a warm-up snapshot. Values are appended
+ * field by field, so the layout does not depend on the struct padding.
+ */
+class INET_API SnapshotWriter
+{
+  protected:
+    std::string data;
+
+  public:
+    /** Appends a trivially copyable value. */
+    template<typename T>
+    void write(const T& value) { data.append(reinterpret_cast<const char *>(&value), sizeof(T)); }
+    void writeString(const std::string& s);
+    void writeAddress(const L3Address& addr) { writeString(addr.isUnspecified() ? "" : addr.str()); }
+    /** Writes the raw simtime value, so the time is read back exactly. */
+    void writeTime(simtime_t t) { write<int64_t>(t.raw()); }
+    void writeNodeData(const NodeData& d);
+
+    const std::string& getData() const { return data; }
+    void clear() { data.clear(); }
+};
+
+/**
+ * Reads back a record written by SnapshotWriter, in the same order; throws
+ * if the record is shorter than what is read.
+ */
+class INET_API SnapshotReader
+{
+  protected:
+    const char *pos;
+    const char *end;
+
+    void require(size_t n) const;
+
+  public:
+    SnapshotReader(const std::string& data) : pos(data.data()), end(data.data() + data.size()) {}
+
+    template<typename T>
+    T read() { T value; require(sizeof(T)); memcpy(&value, pos, sizeof(T)); pos += sizeof(T); return value; }
+    std::string readString();
+    L3Address readAddress();
+    simtime_t readTime() { return SimTime().setRaw(read<int64_t>()); }
+    NodeData readNodeData();
+
+    bool atEnd() const { return pos == end; }
+};
+
+/**
+ * A node whose warm-up state can be saved in and restored from a WarmupSnapshot.
+ */
+class INET_API ISnapshotMember
+{
+  public:
+    virtual ~ISnapshotMember() {}
+    /** Appends the state of the node; called at the end of the warm-up. */
+    virtual void saveSnapshot(SnapshotWriter& w) = 0;
+    /**
+     * Restores the state written by saveSnapshot() at the last init stage;
+     * times of the saved state are shifted by -warmupTime.
+     */
+    virtual void loadSnapshot(SnapshotReader& r, simtime_t warmupTime) = 0;
+};
+
+/**
+ * Saves the warm-up state of the nodes to a file and restores it in later
+ * runs. See NED for more info.
+ */
+class INET_API WarmupSnapshot : public cSimpleModule
+{
+  protected:
+    static const uint32_t MAGIC = 0x574d5550; // "WMUP"
+    static const uint32_t VERSION = 2;
+
+    struct Member
+    {
+        ISnapshotMember *member = nullptr;
+        IMobility *mobility = nullptr;
+    };
+    struct Record
+    {
+        std::string mobilityPath;
+        Coord position;
+        std::string data;
+        bool restored = false;
+    };
+
+    std::string saveFile;
+    cMessage *timer = nullptr; // save in save mode, check of the restored members in load mode
+    std::map<int, Member> members; // by index
+
+    std::string loadFile;
+    simtime_t warmupTime;
+    std::map<int, Record> records; // loaded, by index
+
+    virtual int numInitStages() const override { return NUM_INIT_STAGES; }
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override;
+
+    /** Seed set of the run, stored in the snapshot. */
+    std::string getSeedSet() const;
+    void save();
+    void load();
+    /** Sets the initial position parameters of the mobility modules to the saved positions. */
+    void presetPositions();
+
+  public:
+    WarmupSnapshot() {}
+    ~WarmupSnapshot();
+
+    bool isLoading() const { return !loadFile.empty(); }
+
+    /**
+     * Registers a node; index identifies it in the file (e.g. the host index).
+     * When loading, the saved state of the node is restored right away.
+     */
+    void registerMember(int index, ISnapshotMember *member, IMobility *mobility);
+};
+
+} // namespace inet
+
+#endif /* INET_APPLICATIONS_BROADCASTWIRELESS_WARMUPSNAPSHOT_H_ */
@@ -0,0 +1,274 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+
+// Aggregates the scalar results of a parameter sweep: reads all the .sca files
+// under the given directories in parallel (memory-mapped), groups the runs by
+// their iteration variables (all but the repetition) and prints the mean and
+// the 95% confidence interval of the selected scalars of each cell as CSV.
+//
+// With -D, the cells are compared instead along one iteration variable (e.g.
+// dissType): for each other level of the variable, the scalars of each run
+// minus those of the run with the same repetition (seed) at the baseline level,
+// with the mean and 95% confidence interval of these paired differences. With
+// common random numbers (see omnetpp.ini) the paired runs share their workload,
+// so the differences need far fewer repetitions than the separate means.
+//
+// Usage: ScaAggregate [-j threads] [-p scalar-prefix] [-o out.csv] [-D var [-b baseline]] dir|file...
+//   -p  only the scalars whose name starts with the prefix (default "OK - ")
+//   -b  baseline level of the -D variable (default: the lowest one)
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ScaFile.h"
+
+namespace {
+
+void collectFiles(const char *path, std::vector<std::string>& files)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (auto& entry : fs::recursive_directory_iterator(path, ec))
+            if (entry.is_regular_file() && entry.path().extension() == ".sca")
+                files.push_back(entry.path().string());
+    }
+    else {
+        files.push_back(path);
+    }
+}
+
+std::string csvField(const std::string& s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos)
+        return s;
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"')
+            quoted.push_back('"');
+        quoted.push_back(c);
+    }
+    return quoted + "\"";
+}
+
+// "module name" keys are written as two columns
+void writeStat(FILE *out, const std::string& scalar, const Stat& st)
+{
+    size_t sep = scalar.find(' ');
+    fprintf(out, "%s,%s,%ld,%.10g,%.10g,%.10g\n", csvField(scalar.substr(0, sep)).c_str(),
+            csvField(scalar.substr(sep + 1)).c_str(), st.n, st.mean, st.stddev(), st.ci95());
+}
+
+// mean and CI of each scalar per cell; the repetition is not an iteration variable
+int writeCells(FILE *out, const std::vector<std::string>& varNames, const std::vector<RunResult *>& runs)
+{
+    std::map<std::vector<std::string>, std::map<std::string, Stat>> cells;
+    for (RunResult *r : runs) {
+        std::vector<std::string> key;
+        for (auto& v : r->itervars)
+            key.push_back(v.second);
+        auto& cell = cells[key];
+        for (auto& s : r->scalars)
+            cell[s.first].add(s.second);
+    }
+
+    for (auto& name : varNames)
+        fprintf(out, "%s,", csvField(name).c_str());
+    fprintf(out, "module,scalar,n,mean,stddev,ci95\n");
+    for (auto& cell : cells) {
+        for (auto& s : cell.second) {
+            for (auto& value : cell.first)
+                fprintf(out, "%s,", csvField(value).c_str());
+            writeStat(out, s.first, s.second);
+        }
+    }
+
+    fprintf(stderr, "%zu runs, %zu cells\n", runs.size(), cells.size());
+    return 0;
+}
+
+// numbers in numeric order, anything else as strings
+bool levelLess(const std::string& a, const std::string& b)
+{
+    char *ea, *eb;
+    double da = strtod(a.c_str(), &ea), db = strtod(b.c_str(), &eb);
+    if (*ea == 0 && *eb == 0 && !a.empty() && !b.empty())
+        return da < db;
+    return a < b;
+}
+
+// differences to the baseline level of pairVar, between runs with the same repetition
+int writePairedDifferences(FILE *out, const std::vector<std::string>& varNames, const std::vector<RunResult *>& runs,
+        const std::string& pairVar, std::string baseline)
+{
+    auto pairIt = std::find(varNames.begin(), varNames.end(), pairVar);
+    if (pairIt == varNames.end()) {
+        fprintf(stderr, "No iteration variable %s\n", pairVar.c_str());
+        return 1;
+    }
+    size_t pairIndex = pairIt - varNames.begin();
+
+    // other variables -> repetition -> level -> run
+    std::map<std::vector<std::string>, std::map<std::string, std::map<std::string, RunResult *>>> groups;
+    std::vector<std::string> levels;
+    for (RunResult *r : runs) {
+        std::vector<std::string> key;
+        for (size_t k = 0; k < r->itervars.size(); k++)
+            if (k != pairIndex)
+                key.push_back(r->itervars[k].second);
+        const std::string& level = r->itervars[pairIndex].second;
+        groups[key][r->repetition][level] = r;
+        if (std::find(levels.begin(), levels.end(), level) == levels.end())
+            levels.push_back(level);
+    }
+    std::sort(levels.begin(), levels.end(), levelLess);
+    if (baseline.empty())
+        baseline = levels.front();
+    else if (std::find(levels.begin(), levels.end(), baseline) == levels.end()) {
+        fprintf(stderr, "No run with %s=%s\n", pairVar.c_str(), baseline.c_str());
+        return 1;
+    }
+
+    for (size_t k = 0; k < varNames.size(); k++)
+        if (k != pairIndex)
+            fprintf(out, "%s,", csvField(varNames[k]).c_str());
+    fprintf(out, "%s,baseline,module,scalar,n,mean_diff,stddev,ci95\n", csvField(pairVar).c_str());
+
+    long numPairs = 0;
+    for (auto& group : groups) {
+        for (auto& level : levels) {
+            if (level == baseline)
+                continue;
+            std::map<std::string, Stat> diffs;
+            for (auto& rep : group.second) {
+                auto base = rep.second.find(baseline);
+                auto other = rep.second.find(level);
+                if (base == rep.second.end() || other == rep.second.end())
+                    continue;
+                std::map<std::string, double> baseValues(base->second->scalars.begin(), base->second->scalars.end());
+                for (auto& s : other->second->scalars) {
+                    auto b = baseValues.find(s.first);
+                    if (b != baseValues.end())
+                        diffs[s.first].add(s.second - b->second);
+                }
+                numPairs++;
+            }
+            for (auto& d : diffs) {
+                for (auto& value : group.first)
+                    fprintf(out, "%s,", csvField(value).c_str());
+                fprintf(out, "%s,%s,", csvField(level).c_str(), csvField(baseline).c_str());
+                writeStat(out, d.first, d.second);
+            }
+        }
+    }
+
+    fprintf(stderr, "%zu runs, %ld pairs, baseline %s=%s\n", runs.size(), numPairs, pairVar.c_str(), baseline.c_str());
+    return 0;
+}
+
+void usage()
+{
+    fprintf(stderr, "Usage: ScaAggregate [-j threads] [-p scalar-prefix] [-o out.csv] [-D var [-b baseline]] dir|file...\n");
+    exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::string prefix = "OK - ";
+    const char *outFile = nullptr;
+    std::string pairVar;
+    std::string baseline;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            numThreads = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+            prefix = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            outFile = argv[++i];
+        else if (!strcmp(argv[i], "-D") && i + 1 < argc)
+            pairVar = argv[++i];
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+            baseline = argv[++i];
+        else if (argv[i][0] == '-')
+            usage();
+        else
+            collectFiles(argv[i], files);
+    }
+    if (files.empty())
+        usage();
+    std::sort(files.begin(), files.end());
+
+    // parse: one file at a time per thread, from a shared counter
+    std::vector<RunResult> results(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+        results[i].file = files[i];
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < std::min<size_t>(numThreads, files.size()); t++) {
+        threads.emplace_back([&]() {
+            for (size_t i; (i = next++) < results.size(); )
+                parseFile(results[i], prefix);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // all the runs must have the same iteration variables
+    std::vector<std::string> varNames;
+    std::vector<RunResult *> runs;
+    for (RunResult& r : results) {
+        if (!r.ok) {
+            fprintf(stderr, "Cannot read %s\n", r.file.c_str());
+            continue;
+        }
+        std::vector<std::string> names;
+        for (auto& v : r.itervars)
+            names.push_back(v.first);
+        if (runs.empty())
+            varNames = names;
+        else if (names != varNames) {
+            fprintf(stderr, "%s: different iteration variables, skipped\n", r.file.c_str());
+            continue;
+        }
+        runs.push_back(&r);
+    }
+
+    FILE *out = stdout;
+    if (outFile != nullptr && (out = fopen(outFile, "w")) == nullptr) {
+        perror(outFile);
+        return 1;
+    }
+    int status = pairVar.empty() ? writeCells(out, varNames, runs) : writePairedDifferences(out, varNames, runs, pairVar, baseline);
+    if (out != stdout)
+        fclose(out);
+    return status;
+}
@@ -0,0 +1,156 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+#ifndef TOOLS_SCAFILE_H_
+#define TOOLS_SCAFILE_H_
+
+// Reading of OMNeT++ scalar result files, shared by the tools.
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct RunResult
+{
+    std::string file;
+    bool ok = false;
+    std::vector<std::pair<std::string, std::string>> itervars;  // in file order
+    std::string repetition;
+    std::vector<std::pair<std::string, double>> scalars;        // "module name" -> value
+};
+
+struct Stat
+{
+    long n = 0;
+    double mean = 0;
+    double m2 = 0;
+
+    void add(double x) {
+        n++;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+    }
+    double stddev() const { return n > 1 ? std::sqrt(m2 / (n - 1)) : 0; }
+    /** Half-width of the 95% confidence interval of the mean, NaN below 2 samples. */
+    double ci95() const;
+};
+
+// two-sided 95% quantile of Student's t distribution
+inline double tQuantile95(long df)
+{
+    static const double table[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df <= 0)
+        return NAN;
+    if (df <= 30)
+        return table[df];
+    // Cornish-Fisher expansion around the normal quantile
+    const double z = 1.959964;
+    double z3 = z * z * z, z5 = z3 * z * z;
+    return z + (z3 + z) / (4 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df);
+}
+
+inline double Stat::ci95() const
+{
+    return n > 1 ? tQuantile95(n - 1) * stddev() / std::sqrt((double)n) : NAN;
+}
+
+// splits a .sca line into tokens; quoted tokens may contain spaces and backslash escapes
+inline void tokenize(std::string_view line, std::vector<std::string>& tokens)
+{
+    tokens.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t'))
+            i++;
+        if (i >= line.size())
+            break;
+        std::string token;
+        if (line[i] == '"') {
+            for (i++; i < line.size() && line[i] != '"'; i++) {
+                if (line[i] == '\\' && i + 1 < line.size())
+                    i++;
+                token.push_back(line[i]);
+            }
+            i++;
+        }
+        else {
+            while (i < line.size() && line[i] != ' ' && line[i] != '\t')
+                token.push_back(line[i++]);
+        }
+        tokens.push_back(std::move(token));
+    }
+}
+
+inline void parseFile(RunResult& result, const std::string& prefix)
+{
+    int fd = open(result.file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    std::string_view text((const char *)map, st.st_size);
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        // cheap filter on the keyword before tokenizing
+        if (line.compare(0, 7, "scalar ") == 0) {
+            tokenize(line, tokens);
+            if (tokens.size() >= 4 && tokens[2].compare(0, prefix.size(), prefix) == 0)
+                result.scalars.emplace_back(tokens[1] + " " + tokens[2], strtod(tokens[3].c_str(), nullptr));
+        }
+        else if (line.compare(0, 16, "attr repetition ") == 0) {
+            tokenize(line, tokens);
+            if (tokens.size() >= 3)
+                result.repetition = tokens[2];
+        }
+        else if (line.compare(0, 8, "itervar ") == 0) {
+            tokenize(line, tokens);
+            if (tokens.size() >= 3)
+                result.itervars.emplace_back(tokens[1], tokens[2]);
+        }
+    }
+    munmap(map, st.st_size);
+    result.ok = true;
+}
+
+#endif /* TOOLS_SCAFILE_H_ */
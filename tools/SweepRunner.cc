@@ -0,0 +1,627 @@
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/.
+//
+
+
+
+// Runs all the runs of a configuration on the local cores and records, for
+// each run, its wall-clock time, number of events, events/s and peak RSS in
+// <dir>/<config>.runs.tsv.
+//
+// A run is skipped when its last successful execution had the same hash and
+// its scalar file still exists: the hash covers the run's configuration as
+// printed by the simulation ("-q config", with the iteration variables and seed
+// substituted), the contents of the simulation binary, of the libraries loaded
+// with -l and of every shared library they link (as resolved by ldd, e.g.
+// libINET), and the .ned and .ini files on the NED path (-n, else NEDPATH,
+// else the current directory) together with the ini file. Changing one value
+// of an iteration variable therefore only re-runs the runs that use it. Runs
+// whose scalar file cannot be told from their configuration are never reused.
+//
+// With -C, the repetitions are run in waves instead: first -m repetitions of
+// every cell (a cell is a combination of the iteration variables), then -w more
+// for the cells in which one of the target scalars still has a 95% confidence
+// interval half-width above -e times its mean, until -M repetitions. The
+// repetitions are numbered as if "repeat" was -M, so the ones run in this mode
+// are the same runs as in a full sweep and are reused either way.
+//
+// Usage: SweepRunner -c config [-f omnetpp.ini] [-j jobs] [-d dir] [-r runfilter] [-n]
+//                    [-C "scalar;scalar..." [-e 0.05] [-m 3] [-w 2] [-M 30]] -- simulation args...
+//   -n  only print what would be run (without -C)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ScaFile.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+struct Run
+{
+    int number = 0;
+    std::string itervars;   // as printed by "-q runs", identifies the run in the manifest
+    std::string cell;       // itervars without the repetition
+    int repetition = 0;
+    std::string hash;
+    std::string scaFile;    // output-scalar-file of the run
+    bool done = false;      // has results with the current hash
+};
+
+struct Outcome
+{
+    std::string hash;
+    int status = -1;
+};
+
+std::string config;
+std::string iniFile = "omnetpp.ini";
+std::string dir = "results";
+std::string runFilter;
+std::vector<std::string> command;
+
+uint64_t fnv1a(const void *data, size_t size, uint64_t h = 1469598103934665603ULL)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool hashFile(const std::string& path, uint64_t& h)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::vector<char> buf(1 << 20);
+    while (in) {
+        in.read(buf.data(), buf.size());
+        h = fnv1a(buf.data(), in.gcount(), h);
+    }
+    return true;
+}
+
+std::string findInPath(const std::string& name)
+{
+    if (name.find('/') != std::string::npos)
+        return name;
+    const char *path = getenv("PATH");
+    std::stringstream ss(path ? path : "");
+    std::string d;
+    while (std::getline(ss, d, ':')) {
+        std::string candidate = d + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0)
+            return candidate;
+    }
+    return name;
+}
+
+std::string quote(const std::string& s)
+{
+    std::string q = "'";
+    for (char c : s) {
+        if (c == '\'')
+            q += "'\\''";
+        else
+            q += c;
+    }
+    return q + "'";
+}
+
+// the shared libraries the file is linked against, as resolved by ldd
+void addLinkedLibraries(const std::string& file, std::set<std::string>& out)
+{
+    std::string cmd = "ldd " + quote(file) + " 2>/dev/null";
+    FILE *p = popen(cmd.c_str(), "r");
+    if (p == nullptr)
+        return;
+    // "\tlibINET.so => /path/libINET.so (0x...)" or "\t/lib64/ld-linux-x86-64.so.2 (0x...)"
+    char buf[4096];
+    while (fgets(buf, sizeof(buf), p) != nullptr) {
+        std::string line = buf;
+        size_t arrow = line.find("=> ");
+        size_t from = arrow != std::string::npos ? arrow + 3 : line.find_first_not_of(" \t");
+        if (from == std::string::npos || line[from] != '/')
+            continue;
+        size_t to = line.find(" (", from);
+        out.insert(line.substr(from, to == std::string::npos ? std::string::npos : to - from));
+    }
+    pclose(p);
+}
+
+// the binary, the libraries loaded with -l and everything they link
+uint64_t hashBinaries()
+{
+    uint64_t h = fnv1a("", 0);
+    std::string binary = findInPath(command[0]);
+    if (!hashFile(binary, h)) {
+        fprintf(stderr, "Cannot read %s\n", command[0].c_str());
+        exit(1);
+    }
+    std::set<std::string> linked;
+    addLinkedLibraries(binary, linked);
+    for (size_t i = 1; i + 1 < command.size(); i++) {
+        if (command[i] != "-l")
+            continue;
+        const std::string& lib = command[i + 1];
+        size_t slash = lib.rfind('/');
+        std::string dirPart = slash == std::string::npos ? "" : lib.substr(0, slash + 1);
+        std::string base = lib.substr(dirPart.size());
+        for (const std::string& candidate : { lib, lib + ".so", dirPart + "lib" + base + ".so" }) {
+            if (hashFile(candidate, h)) {
+                addLinkedLibraries(candidate, linked);
+                break;
+            }
+        }
+    }
+    for (const std::string& lib : linked) {
+        h = fnv1a(lib.data(), lib.size(), h);
+        hashFile(lib, h);
+    }
+    return h;
+}
+
+// the .ned and .ini files under the directories of the NED path, and the ini file
+uint64_t hashSources(uint64_t h)
+{
+    std::string nedPath;
+    for (size_t i = 1; i < command.size(); i++) {
+        if (command[i] == "-n" && i + 1 < command.size())
+            nedPath += (nedPath.empty() ? "" : ";") + command[i + 1];
+        else if (command[i].compare(0, 11, "--ned-path=") == 0)
+            nedPath += (nedPath.empty() ? "" : ";") + command[i].substr(11);
+    }
+    if (nedPath.empty() && getenv("NEDPATH") != nullptr)
+        nedPath = getenv("NEDPATH");
+    if (nedPath.empty())
+        nedPath = ".";
+
+    namespace fs = std::filesystem;
+    std::set<std::string> files;
+    files.insert(iniFile);
+    std::string root;
+    std::stringstream ss(nedPath);
+    while (std::getline(ss, root, nedPath.find(';') != std::string::npos ? ';' : ':')) {
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::string ext = it->path().extension().string();
+            if ((ext == ".ned" || ext == ".ini") && it->is_regular_file(ec))
+                files.insert(it->path().lexically_normal().string());
+        }
+    }
+    for (const std::string& file : files) {
+        h = fnv1a(file.data(), file.size(), h);
+        hashFile(file, h);
+    }
+    return h;
+}
+
+// runs the simulation with the given extra arguments and returns its output
+std::string query(const std::vector<std::string>& args)
+{
+    std::string cmd;
+    for (auto& a : command)
+        cmd += quote(a) + " ";
+    for (auto& a : args)
+        cmd += quote(a) + " ";
+    cmd += "2>/dev/null";
+    FILE *p = popen(cmd.c_str(), "r");
+    if (p == nullptr)
+        return "";
+    std::string out;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), p)) > 0)
+        out.append(buf, n);
+    if (pclose(p) != 0) {
+        fprintf(stderr, "Failed: %s\n", cmd.c_str());
+        exit(1);
+    }
+    return out;
+}
+
+std::vector<Run> enumerateRuns()
+{
+    std::vector<std::string> args = { "-f", iniFile, "-c", config, "-q", "runs" };
+    if (!runFilter.empty()) {
+        args.push_back("-r");
+        args.push_back(runFilter);
+    }
+    // "Run 12: $numHosts=4, $dissType=1, $repetition=2"
+    std::vector<Run> runs;
+    std::stringstream ss(query(args));
+    std::string line;
+    while (std::getline(ss, line)) {
+        if (line.compare(0, 4, "Run ") != 0)
+            continue;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;
+        Run run;
+        run.number = atoi(line.c_str() + 4);
+        run.itervars = line.substr(colon + 1);
+        run.itervars.erase(0, run.itervars.find_first_not_of(' '));
+        runs.push_back(run);
+    }
+    return runs;
+}
+
+std::string manifestFile() { return dir + "/" + config + ".runs.tsv"; }
+
+// last outcome of each run, by iteration variables
+std::map<std::string, Outcome> readManifest()
+{
+    std::map<std::string, Outcome> outcomes;
+    std::ifstream in(manifestFile());
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        // hash, run, status, wall, events, events/s, peak RSS, itervars
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, '\t'))
+            f.push_back(field);
+        if (f.size() < 8)
+            continue;
+        outcomes[f[7]] = Outcome{ f[0], atoi(f[2].c_str()) };
+    }
+    return outcomes;
+}
+
+// last "event #N" of the Cmdenv output
+long parseEvents(const std::string& logFile)
+{
+    std::ifstream in(logFile);
+    std::string line;
+    long events = -1;
+    while (std::getline(in, line)) {
+        size_t pos = line.rfind("vent #");
+        if (pos != std::string::npos)
+            events = atol(line.c_str() + pos + 6);
+    }
+    return events;
+}
+
+std::string toHex(uint64_t h)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
+    return buf;
+}
+
+// the hash and the scalar file of each run, from its configuration; one query per run, in parallel
+void queryRunConfigs(std::vector<Run>& runs, uint64_t binaryHash, int numJobs)
+{
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min<int>(numJobs, runs.size()); t++) {
+        threads.emplace_back([&]() {
+            for (size_t k; (k = next++) < runs.size(); ) {
+                Run& run = runs[k];
+                std::stringstream ss(query({ "-f", iniFile, "-c", config, "-r", std::to_string(run.number), "-q", "config" }));
+                std::string line, hashed;
+                while (std::getline(ss, line)) {
+                    size_t key = line.find_first_not_of(" \t");
+                    size_t eq = line.find('=');
+                    if (key == std::string::npos || eq == std::string::npos) {
+                        hashed += line + "\n";
+                        continue;
+                    }
+                    std::string name = line.substr(key, line.find_last_not_of(" \t", eq - 1) + 1 - key);
+                    // the number of repetitions does not change what a run computes
+                    if (name == "repeat")
+                        continue;
+                    hashed += line + "\n";
+                    if (name == "output-scalar-file") {
+                        std::string value = line.substr(line.find_first_not_of(" \t", eq + 1));
+                        if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                            value = value.substr(1, value.size() - 2);
+                        run.scaFile = value;
+                    }
+                }
+                run.hash = toHex(fnv1a(hashed.data(), hashed.size(), binaryHash));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+FILE *manifest = nullptr;
+
+// executes the runs on numJobs processes at a time, returns the number of failed runs
+int executeRuns(const std::vector<Run *>& batch, int numJobs)
+{
+    if (batch.empty())
+        return 0;
+
+    std::string logDir = dir + "/logs";
+    mkdir(dir.c_str(), 0777);
+    mkdir(logDir.c_str(), 0777);
+
+    if (manifest == nullptr) {
+        manifest = fopen(manifestFile().c_str(), "a");
+        if (manifest == nullptr) {
+            perror(manifestFile().c_str());
+            exit(1);
+        }
+        if (ftell(manifest) == 0)
+            fprintf(manifest, "# hash\trun\tstatus\twall [s]\tevents\tevents/s\tpeak RSS [kB]\titervars\n");
+        fflush(manifest);
+    }
+
+    std::mutex mutex;
+    std::atomic<size_t> next(0);
+    std::atomic<int> numFailed(0);
+    auto worker = [&]() {
+        for (size_t k; (k = next++) < batch.size(); ) {
+            Run& run = *batch[k];
+            std::string logFile = logDir + "/" + config + "-" + std::to_string(run.number) + ".log";
+            std::vector<std::string> args = command;
+            for (const char *a : { "-f", iniFile.c_str(), "-c", config.c_str(), "-r" })
+                args.push_back(a);
+            args.push_back(std::to_string(run.number));
+            std::vector<char *> cargs;
+            for (auto& a : args)
+                cargs.push_back(const_cast<char *>(a.c_str()));
+            cargs.push_back(nullptr);
+
+            int fd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+            auto start = std::chrono::steady_clock::now();
+            pid_t pid = fd < 0 ? -1 : fork();
+            if (pid == 0) {
+                dup2(fd, 1);
+                dup2(fd, 2);
+                execvp(cargs[0], cargs.data());
+                _exit(127);
+            }
+            int status = -1;
+            struct rusage usage = {};
+            if (pid > 0 && wait4(pid, &status, 0, &usage) > 0)
+                status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (fd >= 0)
+                close(fd);
+
+            long events = parseEvents(logFile);
+            double eventsPerSec = events >= 0 && wall > 0 ? events / wall : 0;
+            if (status != 0)
+                numFailed++;
+            else
+                run.done = true;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            fprintf(manifest, "%s\t%d\t%d\t%.3f\t%ld\t%.0f\t%ld\t%s\n", run.hash.c_str(), run.number, status,
+                    wall, events, eventsPerSec, usage.ru_maxrss, run.itervars.c_str());
+            fflush(manifest);
+            fprintf(stderr, "[%zu/%zu] run %d %s: %.1f s, %.0f events/s, %ld kB%s\n", k + 1, batch.size(), run.number,
+                    run.itervars.c_str(), wall, eventsPerSec, usage.ru_maxrss, status != 0 ? ", FAILED" : "");
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min<int>(numJobs, batch.size()); t++)
+        threads.emplace_back(worker);
+    for (auto& thread : threads)
+        thread.join();
+
+    if (numFailed > 0)
+        fprintf(stderr, "%d runs failed, see %s\n", numFailed.load(), logDir.c_str());
+    return numFailed;
+}
+
+// true if every target scalar of the cell has a tight enough confidence interval
+bool isConverged(const std::vector<Run *>& cellRuns, const std::vector<std::string>& targets, double relativeCI)
+{
+    std::map<std::string, Stat> stats;
+    for (Run *run : cellRuns) {
+        if (!run->done)
+            continue;
+        RunResult result;
+        result.file = run->scaFile;
+        parseFile(result, "");
+        if (!result.ok) {
+            fprintf(stderr, "Cannot read %s\n", run->scaFile.c_str());
+            continue;
+        }
+        for (auto& s : result.scalars) {
+            std::string name = s.first.substr(s.first.find(' ') + 1);
+            for (auto& target : targets)
+                if (name == target)
+                    stats[target].add(s.second);
+        }
+    }
+    for (auto& target : targets) {
+        auto it = stats.find(target);
+        if (it == stats.end() || it->second.n < 2)
+            return false;
+        const Stat& st = it->second;
+        if (st.ci95() > relativeCI * std::fabs(st.mean))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int numJobs = std::max(1u, std::thread::hardware_concurrency());
+    bool dryRun = false;
+    std::vector<std::string> targets;
+    double relativeCI = 0.05;
+    int minReps = 3;
+    int waveReps = 2;
+    int maxReps = 30;
+    int i = 1;
+    for (; i < argc && strcmp(argv[i], "--") != 0; i++) {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            config = argv[++i];
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+            iniFile = argv[++i];
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            numJobs = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+            dir = argv[++i];
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            runFilter = argv[++i];
+        else if (!strcmp(argv[i], "-n"))
+            dryRun = true;
+        else if (!strcmp(argv[i], "-C") && i + 1 < argc) {
+            std::stringstream ss(argv[++i]);
+            std::string target;
+            while (std::getline(ss, target, ';'))
+                if (!target.empty())
+                    targets.push_back(target);
+        }
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc)
+            relativeCI = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc)
+            minReps = std::max(2, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+            waveReps = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "-M") && i + 1 < argc)
+            maxReps = std::max(1, atoi(argv[++i]));
+        else
+            break;
+    }
+    for (i++; i < argc; i++)
+        command.push_back(argv[i]);
+    if (config.empty() || command.empty()) {
+        fprintf(stderr, "Usage: SweepRunner -c config [-f omnetpp.ini] [-j jobs] [-d dir] [-r runfilter] [-n]\n"
+                "                   [-C \"scalar;scalar...\" [-e 0.05] [-m 3] [-w 2] [-M 30]] -- simulation args...\n");
+        return 1;
+    }
+    if (!targets.empty())
+        command.push_back("--repeat=" + std::to_string(maxReps));
+
+    std::vector<Run> runs = enumerateRuns();
+    uint64_t binaryHash = hashSources(hashBinaries());
+    std::map<std::string, Outcome> previous = readManifest();
+    queryRunConfigs(runs, binaryHash, numJobs);
+
+    int numReused = 0;
+    for (Run& run : runs) {
+        auto it = previous.find(run.itervars);
+        run.done = it != previous.end() && it->second.status == 0 && it->second.hash == run.hash
+                && !run.scaFile.empty() && access(run.scaFile.c_str(), R_OK) == 0;
+        numReused += run.done;
+    }
+
+    if (targets.empty()) {
+        std::vector<Run *> pending;
+        for (Run& run : runs)
+            if (!run.done)
+                pending.push_back(&run);
+        fprintf(stderr, "%s: %zu runs, %zu to run, %d reused\n", config.c_str(), runs.size(), pending.size(), numReused);
+        if (dryRun) {
+            for (Run *run : pending)
+                printf("%d\t%s\n", run->number, run->itervars.c_str());
+            return 0;
+        }
+        int numFailed = executeRuns(pending, numJobs);
+        if (manifest != nullptr)
+            fclose(manifest);
+        return numFailed > 0 ? 1 : 0;
+    }
+
+    // waves of repetitions per cell, in repetition order
+    std::map<std::string, std::vector<Run *>> cells;
+    for (Run& run : runs) {
+        size_t pos = run.itervars.find("$repetition=");
+        if (pos == std::string::npos) {
+            fprintf(stderr, "No repetition in the iteration variables of run %d\n", run.number);
+            return 1;
+        }
+        if (run.scaFile.empty() || run.scaFile.find("${") != std::string::npos) {
+            fprintf(stderr, "Cannot find the scalar file of run %d\n", run.number);
+            return 1;
+        }
+        run.repetition = atoi(run.itervars.c_str() + pos + 12);
+        run.cell = run.itervars.substr(0, pos);
+        while (!run.cell.empty() && (run.cell.back() == ' ' || run.cell.back() == ','))
+            run.cell.pop_back();
+        cells[run.cell].push_back(&run);
+    }
+    for (auto& cell : cells)
+        std::sort(cell.second.begin(), cell.second.end(), [](Run *a, Run *b) { return a->repetition < b->repetition; });
+
+    std::map<std::string, int> numScheduled;   // repetitions of each cell used so far
+    std::map<std::string, bool> converged;
+    int numFailed = 0;
+    int numExecuted = 0;
+    for (int wave = 0; ; wave++) {
+        std::vector<Run *> batch;
+        int numCells = 0;
+        for (auto& cell : cells) {
+            int& scheduled = numScheduled[cell.first];
+            if (converged[cell.first] || scheduled >= (int)cell.second.size())
+                continue;
+            int upTo = std::min<int>(cell.second.size(), scheduled == 0 ? minReps : scheduled + waveReps);
+            for (; scheduled < upTo; scheduled++)
+                if (!cell.second[scheduled]->done)
+                    batch.push_back(cell.second[scheduled]);
+            numCells++;
+        }
+        if (numCells == 0)
+            break;
+        fprintf(stderr, "%s wave %d: %d cells, %zu runs to run\n", config.c_str(), wave, numCells, batch.size());
+        numExecuted += batch.size();
+        numFailed += executeRuns(batch, numJobs);
+
+        for (auto& cell : cells) {
+            int scheduled = numScheduled[cell.first];
+            if (!converged[cell.first] && scheduled > 0) {
+                std::vector<Run *> used(cell.second.begin(), cell.second.begin() + scheduled);
+                converged[cell.first] = isConverged(used, targets, relativeCI);
+            }
+        }
+    }
+    if (manifest != nullptr)
+        fclose(manifest);
+
+    int numUsed = 0, numConverged = 0;
+    for (auto& cell : cells) {
+        numUsed += numScheduled[cell.first];
+        numConverged += converged[cell.first];
+        printf("%s\t%d repetitions\t%s\n", cell.first.c_str(), numScheduled[cell.first],
+                converged[cell.first] ? "converged" : "not converged");
+    }
+    fprintf(stderr, "%s: %d of %zu cells converged, %d repetitions used of %zu, %d executed\n",
+            config.c_str(), numConverged, cells.size(), numUsed, runs.size(), numExecuted);
+    return numFailed > 0 ? 1 : 0;
+}